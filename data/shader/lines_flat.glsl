@@ -0,0 +1,34 @@
+#pragma name(lines_flat)
+
+#pragma vertex
+
+#version 330 core
+layout (location = 0) in vec3 in_pos; // already rotated on the CPU
+layout (location = 1) in vec4 in_color;
+
+out vec4 out_color;
+
+layout (std140) uniform Frame {
+    mat4 projection;
+    float z_max;
+};
+uniform mat4 model = mat4(1.0);
+
+void main() {
+    out_color = in_color;
+
+    float z = -(z_max - in_pos.z) / (z_max + 1.0);
+
+    gl_Position = projection * model * vec4(in_pos.x + 0.5, in_pos.y + 0.5, z, 1.0);
+}
+
+#pragma fragment
+
+#version 330 core
+in vec4 out_color;
+
+out vec4 FragColor;
+
+void main() {
+    FragColor = vec4(out_color.xyz * out_color.a, out_color.a);
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma name(particles)
+
+#pragma vertex
+
+#version 330 core
+layout (location = 0) in vec2 in_corner;
+layout (location = 1) in vec3 in_particle; // x, y, age / life
+
+out vec4 out_color;
+out vec2 out_offset;
+
+uniform mat4 mvp;
+uniform vec2 size; // start, end
+uniform vec4 color_start;
+uniform vec4 color_end;
+
+void main() {
+    float t = in_particle.z;
+    gl_Position = mvp * vec4(in_particle.xy + in_corner * mix(size.x, size.y, t), 0.0, 1.0);
+
+    out_color = mix(color_start, color_end, t);
+    out_offset = in_corner * 2.0;
+}
+
+#pragma fragment
+
+#version 330 core
+in vec4 out_color;
+in vec2 out_offset;
+
+out vec4 FragColor;
+
+void main() {
+    // Round with a soft edge
+    float a = out_color.a * (1.0 - smoothstep(0.8, 1.0, length(out_offset)));
+    FragColor = vec4(out_color.xyz * a, a);
+}
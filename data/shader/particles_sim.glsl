@@ -0,0 +1,99 @@
+#pragma name(particles_sim)
+
+#pragma compute
+
+#version 430 core
+layout (local_size_x = 256) in;
+
+// One array per field, so every pass only touches what it reads
+layout (std430, binding = 0) buffer PosX { float px[]; };
+layout (std430, binding = 1) buffer PosY { float py[]; };
+layout (std430, binding = 2) buffer VelX { float vx[]; };
+layout (std430, binding = 3) buffer VelY { float vy[]; };
+layout (std430, binding = 4) buffer Age { float age[]; };
+layout (std430, binding = 5) buffer Life { float life[]; };
+
+// x, y, age / life for every live particle, packed to the front
+layout (std430, binding = 6) buffer Instances { float inst[]; };
+
+// Read straight back as a DrawElementsIndirectCommand
+layout (std430, binding = 7) buffer DrawCmd {
+    uint cmd_count;
+    uint cmd_instance_count;
+    uint cmd_first_index;
+    uint cmd_base_vertex;
+    uint cmd_base_instance;
+};
+
+uniform uint mode; // 0 emits, 1 integrates and collects the live particles
+uniform uint capacity;
+
+uniform uint emit_first;
+uniform uint emit_count;
+uniform uint seed;
+uniform vec2 emit_pos;
+uniform float emit_radius;
+uniform vec2 speed;    // min, max
+uniform vec2 angle;    // min, max in radians
+uniform vec2 lifetime; // min, max in seconds
+
+uniform float dt;
+uniform vec2 gravity;
+uniform float damping; // velocity is multiplied by this every step
+
+// Same hash as the CPU path, so both emit the same particles
+uint pcg(uint v) {
+    uint state = v * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+float rand01(inout uint s) {
+    s = pcg(s);
+    return float(s) / 4294967295.0;
+}
+
+void emit(uint i) {
+    if (i >= emit_count)
+        return;
+
+    uint slot = (emit_first + i) % capacity;
+    uint s = seed ^ (i * 0x9E3779B9u);
+
+    float r = emit_radius * sqrt(rand01(s));
+    float ra = 6.2831853 * rand01(s);
+    float a = mix(angle.x, angle.y, rand01(s));
+    float v = mix(speed.x, speed.y, rand01(s));
+
+    px[slot] = emit_pos.x + r * cos(ra);
+    py[slot] = emit_pos.y + r * sin(ra);
+    vx[slot] = v * cos(a);
+    vy[slot] = v * sin(a);
+    age[slot] = 0.0;
+    life[slot] = mix(lifetime.x, lifetime.y, rand01(s));
+}
+
+void update(uint i) {
+    if (i >= capacity || age[i] >= life[i])
+        return;
+
+    vx[i] = (vx[i] + gravity.x * dt) * damping;
+    vy[i] = (vy[i] + gravity.y * dt) * damping;
+    px[i] += vx[i] * dt;
+    py[i] += vy[i] * dt;
+    age[i] += dt;
+
+    if (age[i] < life[i]) {
+        uint n = atomicAdd(cmd_instance_count, 1u);
+        inst[n * 3u + 0u] = px[i];
+        inst[n * 3u + 1u] = py[i];
+        inst[n * 3u + 2u] = age[i] / life[i];
+    }
+}
+
+void main() {
+    if (mode == 0u)
+        emit(gl_GlobalInvocationID.x);
+    else
+        update(gl_GlobalInvocationID.x);
+}
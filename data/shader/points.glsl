@@ -8,15 +8,18 @@ layout (location = 1) in vec4 in_color;
 
 out vec4 out_color;
 
-uniform float z_max;
-uniform mat4 mvp;
+layout (std140) uniform Frame {
+    mat4 projection;
+    float z_max;
+};
+uniform mat4 model = mat4(1.0);
 
 void main() {
     out_color = in_color;
 
     float z = -(z_max - in_pos.z) / (z_max + 1.0);
 
-    gl_Position = mvp * vec4(in_pos.x + 0.5, in_pos.y + 0.5, z, 1.0);
+    gl_Position = projection * model * vec4(in_pos.x + 0.5, in_pos.y + 0.5, z, 1.0);
 }
 
 #pragma fragment
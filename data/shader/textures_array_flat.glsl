@@ -0,0 +1,39 @@
+#pragma name(textures_array_flat)
+
+#pragma vertex
+
+#version 330 core
+layout (location = 0) in vec3 in_pos; // already rotated on the CPU
+layout (location = 1) in vec4 in_color;
+layout (location = 2) in vec3 in_tex_coords;
+
+out vec4 out_color;
+out vec3 out_tex_coords;
+
+layout (std140) uniform Frame {
+    mat4 projection;
+    float z_max;
+};
+uniform mat4 model = mat4(1.0);
+
+void main() {
+    float z = -(z_max - in_pos.z) / (z_max + 1.0);
+    gl_Position = projection * model * vec4(in_pos.xy, z, 1.0);
+
+    out_color = in_color;
+    out_tex_coords = in_tex_coords;
+}
+
+#pragma fragment
+
+#version 330 core
+in vec4 out_color;
+in vec3 out_tex_coords;
+
+out vec4 FragColor;
+
+uniform sampler2DArray tex;
+
+void main() {
+    FragColor = vec4(out_color.xyz * out_color.a, out_color.a) * texture(tex, out_tex_coords);
+}
\ No newline at end of file
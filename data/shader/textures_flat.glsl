@@ -0,0 +1,51 @@
+#pragma name(textures_flat)
+
+#pragma vertex
+
+#version 330 core
+layout (location = 0) in vec3 in_pos; // already rotated on the CPU
+layout (location = 1) in vec4 in_color;
+layout (location = 2) in vec3 in_tex_coords;
+
+out vec4 out_color;
+out vec2 out_tex_coords;
+flat out int out_sdf;
+
+layout (std140) uniform Frame {
+    mat4 projection;
+    float z_max;
+};
+uniform mat4 model = mat4(1.0);
+
+void main() {
+    float z = -(z_max - in_pos.z) / (z_max + 1.0);
+    gl_Position = projection * model * vec4(in_pos.xy, z, 1.0);
+
+    out_color = in_color;
+    out_tex_coords = in_tex_coords.xy;
+    out_sdf = in_tex_coords.z < 0.0 ? 1 : 0;
+}
+
+#pragma fragment
+
+#version 330 core
+in vec4 out_color;
+in vec2 out_tex_coords;
+flat in int out_sdf;
+
+out vec4 FragColor;
+
+uniform sampler2D tex;
+
+void main() {
+    if (out_sdf == 1) {
+        // Single channel distance field, 0.5 is the edge. Smoothing over one screen pixel keeps
+        // the edge sharp at any scale
+        float d = texture(tex, out_tex_coords).r;
+        float w = max(0.5 * fwidth(d), 1e-4);
+        float a = out_color.a * smoothstep(0.5 - w, 0.5 + w, d);
+        FragColor = vec4(out_color.xyz * a, a);
+    } else {
+        FragColor = vec4(out_color.xyz * out_color.a, out_color.a) * texture(tex, out_tex_coords);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma name(textures_pulled)
+
+#pragma vertex
+
+#version 430 core
+
+// No vertex attributes, every sprite is one record and gl_VertexID picks the sprite and corner
+struct Sprite {
+    vec4 rect;  // x, y, w, h
+    vec2 pivot; // rotation center
+    float angle;
+    float z;
+    vec4 color;
+};
+
+layout (std430, binding = 0) readonly buffer Sprites { Sprite sprites[]; };
+
+out vec4 out_color;
+out vec2 out_tex_coords;
+
+layout (std140) uniform Frame {
+    mat4 projection;
+    float z_max;
+};
+uniform mat4 model = mat4(1.0);
+
+// Two triangles, in the same order as the quad indices the other texture batches use
+const vec2 corners[6] = vec2[](
+    vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),
+    vec2(0.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0)
+);
+
+void main() {
+    Sprite sp = sprites[gl_VertexID / 6];
+    vec2 corner = corners[gl_VertexID % 6];
+
+    float c = cos(sp.angle);
+    float s = sin(sp.angle);
+    vec2 p = sp.rect.xy + corner * sp.rect.zw - sp.pivot;
+    p = vec2(p.x * c - p.y * s, p.x * s + p.y * c) + sp.pivot;
+
+    float z = -(z_max - sp.z) / (z_max + 1.0);
+    gl_Position = projection * model * vec4(p, z, 1.0);
+
+    out_color = sp.color;
+    out_tex_coords = corner;
+}
+
+#pragma fragment
+
+#version 430 core
+in vec4 out_color;
+in vec2 out_tex_coords;
+
+out vec4 FragColor;
+
+uniform sampler2D tex;
+
+void main() {
+    FragColor = vec4(out_color.xyz * out_color.a, out_color.a) * texture(tex, out_tex_coords);
+}
@@ -9,8 +9,11 @@ layout (location = 2) in vec3 in_trans;
 
 out vec4 out_color;
 
-uniform float z_max;
-uniform mat4 mvp;
+layout (std140) uniform Frame {
+    mat4 projection;
+    float z_max;
+};
+uniform mat4 model = mat4(1.0);
 
 void main() {
     out_color = in_color;
@@ -30,7 +33,7 @@ void main() {
 
     float z = -(z_max - in_pos.z) / (z_max + 1.0);
 
-    gl_Position = mvp * trans * vec4(in_pos.xy, z, 1.0);
+    gl_Position = projection * model * trans * vec4(in_pos.xy, z, 1.0);
 }
 
 #pragma fragment
@@ -35,7 +35,7 @@ void Indev::update(double dt) {
 }
 
 void Indev::draw() {
-  ctx->gl.Viewport(0, 0, window->w(), window->h());
+  ctx->viewport(0, 0, window->w(), window->h());
   gfx->clear(imp::rgb("black"));
 
   gfx->draw_rect({100, 100}, {bulbasaur->w() - 1, bulbasaur->h() - 1}, imp::rgb("white"));
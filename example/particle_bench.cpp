@@ -0,0 +1,71 @@
+#include "imp/imp.hpp"
+
+// 1M particle pool, fed from the cursor every frame
+// Space switches between the GPU and CPU backends, watch the ParticleSystem tab in the debug overlay
+constexpr std::size_t CAPACITY = 1'000'000;
+constexpr std::size_t EMIT_PER_FRAME = 20'000;
+
+class ParticleBench : public imp::Application {
+public:
+  std::shared_ptr<imp::Gfx2D> gfx{nullptr};
+  std::shared_ptr<imp::ParticleSystem> particles{nullptr};
+
+  imp::ParticleParams params{
+    .lifetime = {2.0f, 3.0f},
+    .speed = {50.0f, 300.0f},
+    .angle = {200.0f, 340.0f},
+    .size = {3.0f, 1.0f},
+    .gravity = {0.0f, 300.0f},
+    .drag = 0.2f,
+    .color_start = imp::rgb("orange"),
+    .color_end = imp::rgba("red", 0)
+  };
+  std::shared_ptr<imp::ParticlePool> pool{nullptr};
+
+  explicit ParticleBench(const std::weak_ptr<imp::ModuleMgr>& module_mgr);
+
+  void update(double dt) override;
+  void draw() override;
+};
+
+ParticleBench::ParticleBench(const std::weak_ptr<imp::ModuleMgr>& module_mgr) : Application(module_mgr) {
+  debug_overlay->set_flying_log_enabled(true);
+  debug_overlay->set_console_binding("grave_accent");
+
+  gfx = module_mgr.lock()->create<imp::Gfx2D>();
+  particles = module_mgr.lock()->create<imp::ParticleSystem>();
+
+  pool = particles->create(CAPACITY, params);
+}
+
+void ParticleBench::update(double dt) {
+  if (inputs->pressed("escape")) {
+    window->set_should_close(true);
+  }
+
+  if (inputs->pressed("space")) {
+    const auto backend = pool->backend() == imp::ParticleBackend::gpu ? imp::ParticleBackend::cpu
+                                                                       : imp::ParticleBackend::gpu;
+    pool = particles->create(CAPACITY, params, backend);
+    IMP_LOG_INFO("Particles on the {}", pool->backend() == imp::ParticleBackend::gpu ? "GPU" : "CPU");
+  }
+
+  const glm::vec2 cursor = {inputs->mouse_x(), inputs->mouse_y()};
+  particles->emit(*pool, cursor, EMIT_PER_FRAME, 8.0f);
+}
+
+void ParticleBench::draw() {
+  ctx->viewport(0, 0, window->w(), window->h());
+  gfx->clear(imp::rgb("black"));
+
+  particles->draw(*pool, window->projection_matrix());
+}
+
+int main(int, char*[]) {
+  imp::Engine().run_application<ParticleBench>(imp::WindowOpenParams{
+    .title = "Particle Bench",
+    .size = {1280, 720},
+    .mode = imp::WindowMode::windowed,
+    .flags = imp::WindowFlags::centered
+  });
+}
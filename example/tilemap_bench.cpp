@@ -0,0 +1,92 @@
+#include "imp/imp.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+const auto CWD = std::filesystem::current_path();
+const auto IMG_PATH = CWD / "example" / "res" / "img";
+
+// 4096x4096 tiles, 8x8 pixels each, panning across the whole map
+// Watch the fps and the TileMapMgr tab in the debug overlay
+constexpr int MAP_SIZE = 4096;
+constexpr int TILE_SIZE = 8;
+constexpr float PAN_SPEED = 600.0f;
+
+class TilemapBench : public imp::Application {
+public:
+  std::shared_ptr<imp::Gfx2D> gfx{nullptr};
+  std::shared_ptr<imp::TileMapMgr> tile_maps{nullptr};
+
+  std::shared_ptr<imp::Texture> tileset{nullptr};
+  std::shared_ptr<imp::TileMap> map{nullptr};
+
+  glm::vec2 camera{0, 0};
+  glm::vec2 camera_dir{1, 1};
+
+  explicit TilemapBench(const std::weak_ptr<imp::ModuleMgr>& module_mgr);
+
+  void update(double dt) override;
+  void draw() override;
+};
+
+TilemapBench::TilemapBench(const std::weak_ptr<imp::ModuleMgr>& module_mgr) : Application(module_mgr) {
+  debug_overlay->set_flying_log_enabled(true);
+  debug_overlay->set_console_binding("grave_accent");
+
+  gfx = module_mgr.lock()->create<imp::Gfx2D>();
+  tile_maps = module_mgr.lock()->create<imp::TileMapMgr>();
+
+  gfx->set_culling(true);
+
+  tileset = gfx->textures->load(IMG_PATH / "bulbasaur.png", true);
+  const auto tileset_tiles = (tileset->w() / TILE_SIZE) * (tileset->h() / TILE_SIZE);
+
+  imp::Stopwatch sw;
+  sw.start();
+
+  map = tile_maps->create({MAP_SIZE, MAP_SIZE}, tileset, {TILE_SIZE, TILE_SIZE});
+  for (int y = 0; y < MAP_SIZE; ++y)
+    for (int x = 0; x < MAP_SIZE; ++x)
+      map->set(x, y, static_cast<imp::TileId>(imp::rnd::get<int>(1, tileset_tiles)));
+
+  sw.stop();
+  IMP_LOG_INFO("Filled {}x{} tiles in {:.2f}ms", MAP_SIZE, MAP_SIZE, sw.elapsed_msec());
+}
+
+void TilemapBench::update(double dt) {
+  if (inputs->pressed("escape")) {
+    window->set_should_close(true);
+  }
+
+  // Bounce around the map so new chunks keep coming into view
+  const glm::vec2 max_camera = {
+    static_cast<float>(MAP_SIZE * TILE_SIZE - window->w()),
+    static_cast<float>(MAP_SIZE * TILE_SIZE - window->h())
+  };
+  camera += camera_dir * PAN_SPEED * static_cast<float>(dt);
+  for (int i = 0; i < 2; ++i) {
+    if (camera[i] < 0.0f || camera[i] > max_camera[i]) {
+      camera[i] = std::clamp(camera[i], 0.0f, max_camera[i]);
+      camera_dir[i] = -camera_dir[i];
+    }
+  }
+}
+
+void TilemapBench::draw() {
+  ctx->viewport(0, 0, window->w(), window->h());
+  gfx->clear(imp::rgb("black"));
+
+  const auto projection = window->projection_matrix() * glm::translate(glm::mat4(1.0f), glm::vec3(-camera, 0.0f));
+  gfx->set_cull_projection(projection);
+
+  tile_maps->draw(*map);
+
+  gfx->batcher->draw(projection);
+}
+
+int main(int, char*[]) {
+  imp::Engine().run_application<TilemapBench>(imp::WindowOpenParams{
+    .title = "Tilemap Bench",
+    .size = {1280, 720},
+    .mode = imp::WindowMode::windowed,
+    .flags = imp::WindowFlags::centered
+  });
+}
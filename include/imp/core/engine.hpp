@@ -10,6 +10,8 @@
 #include "imp/core/module_mgr.hpp"
 
 #include "imp/gfx/module/dear_imgui.hpp"
+#include "imp/gfx/module/font_mgr.hpp"
+#include "imp/gfx/module/frame_capture.hpp"
 #include "imp/gfx/module/gfx_context.hpp"
 #include "imp/gfx/module/shader_mgr.hpp"
 #include "imp/gfx/module/texture_mgr.hpp"
@@ -63,6 +65,8 @@ void Engine::run_application(const WindowOpenParams& initialize_params) {
   module_mgr_->create<DearImgui>();
   module_mgr_->create<ShaderMgr>();
   module_mgr_->create<TextureMgr>();
+  module_mgr_->create<FontMgr>();
+  module_mgr_->create<FrameCapture>();
 
   module_mgr_->create<TimerMgr>();
 
@@ -43,6 +43,7 @@ concept Numeric = std::integral<T> || std::floating_point<T>;
 
 class Buffer {
 public:
+  GfxContext &ctx;
   GladGLContext &gl;
 
   GLuint id{0};
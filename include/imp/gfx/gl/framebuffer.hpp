@@ -0,0 +1,90 @@
+#ifndef IMP_GFX_GL_FRAMEBUFFER_HPP
+#define IMP_GFX_GL_FRAMEBUFFER_HPP
+
+#include "imp/gfx/module/gfx_context.hpp"
+#include "imp/gfx/gl/renderbuffer.hpp"
+#include "imp/gfx/gl/tex_image.hpp"
+#include <optional>
+#include <vector>
+
+namespace imp {
+// Owns its attachments: color attachments are textures so they can be sampled afterwards,
+// depth/stencil is a renderbuffer since it's only ever tested against
+class Framebuffer {
+public:
+  GfxContext& ctx;
+  GladGLContext& gl;
+
+  GLuint id{0};
+  GLsizei w{0};
+  GLsizei h{0};
+
+  Framebuffer(GfxContext& gfx, GLsizei w, GLsizei h);
+  ~Framebuffer();
+
+  // Copy constructors don't make sense for OpenGL objects
+  Framebuffer(const Framebuffer&) = delete;
+  Framebuffer& operator=(const Framebuffer&) = delete;
+
+  Framebuffer(Framebuffer&& other) noexcept;
+  Framebuffer& operator=(Framebuffer&& other) noexcept;
+
+  // Binds to both the draw and read targets
+  void bind();
+  void unbind();
+
+  // Replaces whatever was at this index, draw buffers are updated to cover every color attachment
+  TexImage& attach_color(TexFormat format, GLuint index = 0, bool retro = false);
+
+  // Depth, stencil or combined depth/stencil depending on the format
+  Renderbuffer& attach_depth_stencil(RBufFormat format);
+
+  TexImage* color(GLuint index = 0);
+  Renderbuffer* depth_stencil();
+
+  // Reallocate every attachment at the new size with the same formats, contents are lost
+  void resize(GLsizei w, GLsizei h);
+
+  // Logs the reason if not
+  bool is_complete();
+
+private:
+  struct ColorAttachment_ {
+    GLuint index;
+    TexFormat format;
+    bool retro;
+    TexImage tex;
+  };
+  std::vector<ColorAttachment_> colors_{};
+
+  struct DepthStencilAttachment_ {
+    RBufFormat format;
+    Renderbuffer rbo;
+  };
+  std::optional<DepthStencilAttachment_> depth_stencil_{};
+
+  // Binds the framebuffer to change it, and puts back whatever the caller had bound when done
+  class EditScope_ {
+  public:
+    explicit EditScope_(Framebuffer& fbo);
+    ~EditScope_();
+
+    EditScope_(const EditScope_&) = delete;
+    EditScope_& operator=(const EditScope_&) = delete;
+
+  private:
+    GfxContext& ctx_;
+    GLuint prev_draw_;
+    GLuint prev_read_;
+  };
+
+  void attach_color_(const ColorAttachment_& a);
+  void attach_depth_stencil_(const DepthStencilAttachment_& a);
+  void update_draw_buffers_();
+
+  void gen_id_();
+  void del_id_();
+};
+} // namespace imp
+
+#endif//IMP_GFX_GL_FRAMEBUFFER_HPP
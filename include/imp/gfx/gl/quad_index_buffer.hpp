@@ -0,0 +1,29 @@
+#ifndef IMP_GFX_GL_QUAD_INDEX_BUFFER_HPP
+#define IMP_GFX_GL_QUAD_INDEX_BUFFER_HPP
+
+#include "imp/gfx/gl/buffer.hpp"
+#include <span>
+
+namespace imp {
+// Element buffer holding 0,1,2,0,2,3 for every quad, offset by 4 vertices each time, so quad
+// vertices can be drawn without uploading any indices. Shared by every batch that only holds quads
+class QuadIndexBuffer : public Buffer {
+public:
+  explicit QuadIndexBuffer(GfxContext& gfx);
+
+  // Grow to cover at least this many quads, never shrinks
+  void reserve(std::size_t quads);
+
+  // In quads
+  std::size_t capacity() const;
+
+private:
+  std::size_t quads_{0};
+};
+
+// 4 vertices drawn as 0,1,2,0,2,3, the layout of every rect and texture Gfx2D submits
+bool is_quad(std::span<const float> data, std::span<const unsigned int> indices, std::size_t floats_per_vertex,
+             bool insert_restart);
+} // namespace imp
+
+#endif//IMP_GFX_GL_QUAD_INDEX_BUFFER_HPP
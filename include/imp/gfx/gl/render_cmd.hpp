@@ -0,0 +1,114 @@
+#ifndef IMP_GFX_GL_RENDER_CMD_HPP
+#define IMP_GFX_GL_RENDER_CMD_HPP
+
+#include "imp/gfx/gl/vec_buffer.hpp"
+#include "imp/gfx/gl/vertex_array.hpp"
+#include "glm/glm.hpp"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace imp {
+enum class RenderCmdType : std::uint8_t {
+  bind_program,
+  bind_vao,
+  bind_texture,
+  set_transform,
+  draw_elements,
+  multi_draw_elements,
+  draw_arrays
+};
+
+// Plain data, so a frame worth of commands can be copied and inspected freely. Commands only
+// name GL objects and index ranges, they don't own them, see execute() for when replaying is safe
+//   bind_program:        id
+//   bind_vao:            id
+//   bind_texture:        target, id
+//   set_transform:       loc_model, id (transform index, 0 for none), z_offset
+//                        (the projection and z_max come from the Frame uniform block)
+//   draw_elements:       target (draw mode), count, first (in indices, not bytes), base_vertex
+//   multi_draw_elements: target (draw mode), count (number of ranges), first (first range in ranges())
+//   draw_arrays:         target (draw mode), count, first (in vertices)
+struct RenderCmd {
+  RenderCmdType type;
+  GLenum target{0};
+  GLuint id{0};
+  GLint loc_model{-1};
+  float z_offset{0.0f};
+  GLsizei count{0};
+  GLsizei first{0};
+  GLint base_vertex{0};
+};
+
+// Laid out the way glMultiDrawElementsIndirect reads it from a GL_DRAW_INDIRECT_BUFFER
+struct DrawElementsIndirectCmd {
+  GLuint count;
+  GLuint instance_count;
+  GLuint first_index;
+  GLint base_vertex;
+  GLuint base_instance;
+};
+static_assert(sizeof(DrawElementsIndirectCmd) == 5 * sizeof(GLuint));
+
+// issued/elided only count state changes, draws are always issued
+// draws counts GL draw calls, ranges counts the index ranges they covered
+struct RenderCmdStats {
+  std::size_t issued{0};
+  std::size_t elided{0};
+  std::size_t draws{0};
+  std::size_t ranges{0};
+};
+
+class RenderCmdBuffer {
+public:
+  void bind_program(GLuint id);
+  void bind_vao(GLuint id);
+  void bind_texture(GLenum target, GLuint id);
+  // Programs are left with an identity model matrix between executes, so this only costs an
+  // upload when something before it in the buffer changed the program's transform
+  void set_transform(GLint loc_model);
+
+  // Draws after this use projection * transform, with z shifted by z_offset
+  void set_transform(GLint loc_model, const glm::mat4& transform, float z_offset);
+
+  // base_vertex is added to every index before fetching, so draws from different parts of one
+  // vertex buffer can still go out together as a multi-draw
+  void draw_elements(DrawMode mode, GLsizei count, GLsizei first, GLint base_vertex = 0);
+
+  // For shaders that fetch their own vertex data, ranges that touch are joined by coalesce()
+  void draw_arrays(DrawMode mode, GLsizei count, GLsizei first);
+
+  // Append every command from other, in order
+  void append(const RenderCmdBuffer& other);
+
+  // Fold draws that don't need separate calls together. Binds that wouldn't change anything
+  // are dropped, ranges that touch (with the same base vertex) are joined, and any other run of
+  // draws with the same program, VAO, texture, uniforms and mode becomes one multi_draw_elements
+  void coalesce();
+
+  std::span<const RenderCmd> commands() const;
+  std::span<const DrawElementsIndirectCmd> ranges() const;
+  std::size_t size() const;
+  bool empty() const;
+  void clear();
+
+  // Issue the commands through the context's state cache, so any bind that wouldn't change
+  // anything is skipped. The buffer is left untouched, but the ranges it draws are only valid
+  // while the buffers they point into still hold the same data. Commands recorded from the
+  // Batcher's per-frame batches go stale once that storage is cleared at the end of the frame,
+  // only ones recorded from a StaticBatch can be executed again later
+  // Textures are bound to unit 0, and the VAO is unbound when finished
+  // Multi-draws are appended to indirect and issued with glMultiDrawElementsIndirect, without
+  // an indirect buffer each of their ranges is drawn on its own. Nothing already in indirect is
+  // rewritten, so it only needs clearing once the GPU is done with every execute that used it
+  // The Frame uniform block has to be bound already, z_max is only needed to work out z offsets
+  RenderCmdStats execute(GfxContext& ctx, float z_max, UVBuffer* indirect = nullptr) const;
+
+private:
+  std::vector<RenderCmd> cmds_{};
+  std::vector<glm::mat4> transforms_{};
+  std::vector<DrawElementsIndirectCmd> ranges_{};
+};
+} // namespace imp
+
+#endif//IMP_GFX_GL_RENDER_CMD_HPP
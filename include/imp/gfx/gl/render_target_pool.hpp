@@ -0,0 +1,73 @@
+#ifndef IMP_GFX_GL_RENDER_TARGET_POOL_HPP
+#define IMP_GFX_GL_RENDER_TARGET_POOL_HPP
+
+#include "imp/gfx/gl/framebuffer.hpp"
+#include "glm/vec2.hpp"
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace imp {
+// Pooled targets that haven't been handed out for this many frames are freed
+inline constexpr std::size_t RENDER_TARGET_EVICT_FRAMES = 120;
+
+struct RenderTargetStats {
+  std::size_t pooled{0};
+  std::size_t in_use{0};
+  std::size_t allocated{0}; // new targets created in the last frame
+};
+
+// Transient offscreen targets, handed out by (size, format) and recycled across frames instead of
+// being created and destroyed every time an offscreen pass runs
+// Anything acquired belongs to the caller until the end of the frame, after which it goes back
+// into the pool. Targets sized relative to the window follow it when the framebuffer is resized
+class RenderTargetPool {
+public:
+  explicit RenderTargetPool(GfxContext& gfx);
+
+  // Fixed size, the color attachment is at index 0
+  Framebuffer& acquire(glm::ivec2 size, TexFormat color = TexFormat::rgba8,
+                       std::optional<RBufFormat> depth_stencil = RBufFormat::d24_s8);
+
+  // The window's framebuffer size times scale
+  Framebuffer& acquire_screen(float scale = 1.0f, TexFormat color = TexFormat::rgba8,
+                              std::optional<RBufFormat> depth_stencil = RBufFormat::d24_s8);
+
+  // Free everything that isn't in use
+  void clear();
+
+  // Counts from the last complete frame
+  const RenderTargetStats& stats() const;
+
+private:
+  friend class GfxContext;
+
+  GfxContext& ctx_;
+
+  struct Entry_ {
+    std::unique_ptr<Framebuffer> fbo;
+    TexFormat color;
+    std::optional<RBufFormat> depth_stencil;
+    std::optional<float> screen_scale; // empty for fixed size targets
+    bool in_use;
+    std::size_t last_used;
+  };
+  std::vector<Entry_> entries_{};
+
+  glm::ivec2 screen_size_{0, 0};
+  std::size_t frame_{0};
+
+  std::size_t frame_allocated_{0};
+  RenderTargetStats last_stats_{};
+
+  Framebuffer& acquire_(glm::ivec2 size, TexFormat color, std::optional<RBufFormat> depth_stencil,
+                        std::optional<float> screen_scale);
+
+  static glm::ivec2 scaled_(glm::ivec2 size, float scale);
+
+  void end_frame_();
+  void resize_screen_(glm::ivec2 size);
+};
+} // namespace imp
+
+#endif//IMP_GFX_GL_RENDER_TARGET_POOL_HPP
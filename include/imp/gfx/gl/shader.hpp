@@ -2,31 +2,75 @@
 #define IMP_GFX_GL_SHADER_HPP
 
 #include "imp/gfx/module/gfx_context.hpp"
+#include "imp/gfx/gl/vertex_layout.hpp"
 #include "glm/glm.hpp"
+#include <deque>
 #include <filesystem>
+#include <functional>
 #include <optional>
+#include <span>
 #include <string>
+#include <vector>
 
 namespace imp {
 struct ShaderSrc {
   std::optional<std::string> name;
   std::optional<std::string> vertex;
   std::optional<std::string> fragment;
+  std::optional<std::string> compute;
 
   std::string get() const;
 
+  // Stable between runs, so it can key anything that outlives the process
+  std::uint64_t hash() const;
+
+  // Hands parse the contents of a file, or nothing if it can't be read
+  using FileReader = std::function<std::optional<std::string>(const std::filesystem::path&)>;
+
   static std::optional<ShaderSrc> parse(const std::string& src);
   static std::optional<ShaderSrc> parse(const std::filesystem::path& path);
+
+  // Files (the shader and everything it includes) come from read instead of straight from disk
+  static std::optional<ShaderSrc> parse(const std::filesystem::path& path, const FileReader& read);
+};
+
+// A linked program as glGetProgramBinary returns it, only good for the same driver
+struct ShaderBinary {
+  GLenum format{0};
+  std::vector<std::byte> data{};
+};
+
+// A uniform location looked up once by Shader::uniform, so setting it needs no name lookup
+// The location follows the shader through recompile(), so the handle can be kept for as long
+// as the shader lives
+template<typename T>
+class Uniform {
+public:
+  Uniform() = default;
+
+  GLint loc() const { return loc_ ? *loc_ : -1; }
+
+private:
+  friend class Shader;
+
+  const GLint* loc_{nullptr};
+
+  explicit Uniform(const GLint* loc) : loc_(loc) {}
 };
 
 class Shader {
 public:
+  GfxContext& ctx;
   GladGLContext& gl;
 
   GLuint id{0};
   std::string name{};
 
   Shader(GfxContext& gfx, const ShaderSrc& src);
+
+  // Load the program from binary, if the driver won't take it src is compiled instead
+  Shader(GfxContext& gfx, const ShaderSrc& src, const ShaderBinary& binary);
+
   ~Shader();
 
   // Copy constructors don't make sense for OpenGL objects
@@ -37,12 +81,49 @@ public:
   Shader& operator=(Shader&& other) noexcept;
 
   std::string src() const;
+  std::uint64_t src_hash() const;
   void recompile(const ShaderSrc& src);
 
+  // False if nothing has linked yet, a failed recompile keeps the previous program
+  bool linked() const;
+
+  // True if the current program was loaded from a binary rather than compiled
+  bool from_binary() const;
+
+  // Empty if nothing has linked, or the driver can't hand the program back
+  std::optional<ShaderBinary> binary() const;
+
   void use();
 
   GLint get_attrib_loc(const std::string& attrib_name);
 
+  // One location per attrib in the layout (-1 if the shader doesn't use it), looked up once
+  std::span<const GLint> attrib_locs(const VertexLayout& layout);
+  GLint get_uniform_loc(const std::string& uniform_name);
+
+  template<typename T>
+  Uniform<T> uniform(const std::string& uniform_name);
+
+  // Point a uniform block at a GL_UNIFORM_BUFFER binding, this is kept through recompile()
+  bool uniform_block(const std::string& block_name, GLuint binding);
+
+  // Like uniform_*, use() has to be called first
+  void set(Uniform<float> u, float v);
+  void set(Uniform<glm::vec2> u, glm::vec2 v);
+  void set(Uniform<glm::vec3> u, glm::vec3 v);
+  void set(Uniform<glm::vec4> u, glm::vec4 v);
+  void set(Uniform<int> u, int v);
+  void set(Uniform<glm::ivec2> u, glm::ivec2 v);
+  void set(Uniform<glm::ivec3> u, glm::ivec3 v);
+  void set(Uniform<glm::ivec4> u, glm::ivec4 v);
+  void set(Uniform<unsigned int> u, unsigned int v);
+  void set(Uniform<glm::uvec2> u, glm::uvec2 v);
+  void set(Uniform<glm::uvec3> u, glm::uvec3 v);
+  void set(Uniform<glm::uvec4> u, glm::uvec4 v);
+  void set(Uniform<glm::mat2> u, const glm::mat2& v);
+  void set(Uniform<glm::mat3> u, const glm::mat3& v);
+  void set(Uniform<glm::mat4> u, const glm::mat4& v);
+
   void uniform_1f(const std::string& uniform_name, float v0);
   void uniform_2f(const std::string& uniform_name, float v0, float v1);
   void uniform_3f(const std::string& uniform_name, float v0, float v1, float v2);
@@ -86,13 +167,23 @@ public:
 
 private:
   ShaderSrc src_;
+  bool linked_{false};
+  bool from_binary_{false};
 
   std::unordered_map<std::string, GLint> attrib_locs_{};
+  std::unordered_map<const VertexLayout*, std::vector<GLint>> layout_locs_{};
 
   std::unordered_map<std::string, GLint> uniform_locs_{};
-  GLint get_uniform_loc_(const std::string& uniform_name);
+
+  // Handed out by uniform(), a deque so the locations never move
+  std::deque<std::pair<std::string, GLint>> uniform_handles_{};
+  std::unordered_map<std::string, GLuint> uniform_blocks_{};
+
+  const GLint* uniform_handle_(const std::string& uniform_name);
+  bool bind_uniform_block_(const std::string& block_name, GLuint binding);
 
   bool compile_shader_src_(const ShaderSrc& src);
+  bool load_binary_(const ShaderSrc& src, const ShaderBinary& binary);
 
   bool check_compile_(GLuint shader_id, GLenum type);
   bool check_link_();
@@ -101,6 +192,11 @@ private:
   void del_id_();
   void del_id_(GLuint id);
 };
+
+template<typename T>
+Uniform<T> Shader::uniform(const std::string& uniform_name) {
+  return Uniform<T>(uniform_handle_(uniform_name));
+}
 } // namespace imp
 
 #endif//IMP_GFX_GL_SHADER_HPP
@@ -73,6 +73,7 @@ StaticBuffer<T>::StaticBuffer(
 
 template<Numeric T>
 StaticBuffer<T>::StaticBuffer(StaticBuffer &&other) noexcept : Buffer(std::move(other)) {
+  std::swap(size_, other.size_);
   std::swap(last_target, other.last_target);
   std::swap(last_usage, other.last_usage);
 }
@@ -82,6 +83,7 @@ StaticBuffer<T> &StaticBuffer<T>::operator=(StaticBuffer &&other) noexcept {
   if (this != &other) {
     Buffer::operator=(std::move(other));
 
+    std::swap(size_, other.size_);
     std::swap(last_target, other.last_target);
     std::swap(last_usage, other.last_usage);
   }
@@ -0,0 +1,56 @@
+#ifndef IMP_GFX_GL_TEX_ARRAY_HPP
+#define IMP_GFX_GL_TEX_ARRAY_HPP
+
+#include "imp/gfx/gl/tex_image.hpp"
+#include "imp/gfx/module/gfx_context.hpp"
+#include "imp/util/io.hpp"
+#include <optional>
+
+namespace imp {
+
+// Layers are allocated up front with TexStorage3D, so the layer count is chosen
+// to keep a single array under this many bytes (at 4 bytes per texel)
+inline constexpr std::size_t TEX_ARRAY_BYTE_BUDGET = 64 * 1024 * 1024;
+
+class TexArray {
+public:
+  GfxContext &ctx;
+  GladGLContext &gl;
+
+  GLuint id{0};
+  GLsizei w{0};
+  GLsizei h{0};
+  GLsizei capacity{0};
+  GLsizei layer_count{0};
+  bool retro{false};
+
+  TexArray(GfxContext &gfx, GLsizei w, GLsizei h, GLsizei capacity, bool retro = false);
+  ~TexArray();
+
+  TexArray(const TexArray &) = delete;
+  TexArray &operator=(const TexArray &) = delete;
+
+  TexArray(TexArray &&other) noexcept;
+  TexArray &operator=(TexArray &&other) noexcept;
+
+  bool full() const;
+
+  // Upload an image into the next free layer, returning the layer index
+  // Fails if the array is full or the image dimensions don't match
+  std::optional<GLsizei> add_layer(ImageData &image_data);
+
+  void bind(int unit = 0);
+  void unbind(int unit = 0);
+
+private:
+  GLsizei levels_{1};
+
+  void upload_mips_(GLsizei layer, GLenum format, const unsigned char* pixels, int comp);
+
+  void gen_id_();
+  void del_id_();
+};
+
+} // namespace imp
+
+#endif//IMP_GFX_GL_TEX_ARRAY_HPP
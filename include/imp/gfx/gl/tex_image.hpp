@@ -99,8 +99,14 @@ enum class TexFormat {
   s8 = GL_STENCIL_INDEX8
 };
 
+enum class TexTarget {
+  tex_2d = GL_TEXTURE_2D,
+  tex_2d_array = GL_TEXTURE_2D_ARRAY
+};
+
 class TexImage {
 public:
+  GfxContext &ctx;
   GladGLContext &gl;
 
   GLuint id{0};
@@ -120,7 +126,7 @@ public:
   TexImage &operator=(TexImage &&other) noexcept;
 
   void bind(int unit = 0);
-  void unbind();
+  void unbind(int unit = 0);
 
 private:
   void gen_id_();
@@ -2,10 +2,15 @@
 #define IMP_GFX_GL_VEC_BUFFER_HPP
 
 #include "imp/gfx/gl/buffer.hpp"
+#include <algorithm>
 #include <concepts>
+#include <memory>
 #include <vector>
 
 namespace imp {
+// CPU-side storage is kept in chunks, so growing only ever allocates a new chunk and never moves
+// what's already there. Each new chunk is as big as everything before it, so capacity still
+// doubles and the chunk count stays logarithmic. Filling in reverse puts new chunks in front
 template<Numeric T = float>
 class VecBuffer : public Buffer {
 public:
@@ -30,24 +35,47 @@ public:
   std::size_t size() const;
   std::size_t capacity() const;
 
+  // Storage held on each side, whether or not it's in use
+  std::size_t cpu_bytes() const;
+  std::size_t gpu_bytes() const;
+
+  // Give back storage beyond capacity elements (never less than what's held right now). The GPU
+  // side is released immediately and allocated again at the new size on the next sync
+  void shrink(std::size_t capacity);
+
   void add(const std::vector<T>& new_data);
   void add(std::initializer_list<T> new_data);
 
   template<std::ranges::input_range R>
   void add(const R& new_data);
 
+  // Uploads go out one BufferSubData per chunk touched
   void sync();
 
 private:
   BufTarget target_{BufTarget::none};
   BufUsage usage_{BufUsage::none};
 
-  std::vector<T> data_{};
+  struct Chunk_ {
+    std::unique_ptr<T[]> data;
+    std::size_t size;
+  };
+  std::vector<Chunk_> chunks_{};
+  std::size_t capacity_{0};
+
   std::size_t front_{0}, back_{0};
   bool fill_reverse_{false};
 
   GLuint gl_bufsize_{0u}, gl_bufpos_{0u};
 
+  void grow_(std::size_t size);
+
+  // Calls f(ptr, pos, count) for each run of [first, last) that sits in a single chunk
+  template<typename F>
+  void for_range_(std::size_t first, std::size_t last, F&& f);
+
+  void upload_(std::size_t first, std::size_t last);
+
   template<typename InputIt>
   void add_(InputIt begin, InputIt end);
 };
@@ -62,7 +90,7 @@ VecBuffer<T>::VecBuffer(
   std::size_t initial_size, bool fill_reverse,
   BufTarget target, BufUsage usage
 ) : Buffer(gfx), target_(target), usage_(usage), fill_reverse_(fill_reverse) {
-  data_.resize(initial_size);
+  grow_(initial_size);
   if (fill_reverse_) {
     front_ = initial_size;
     back_ = initial_size;
@@ -73,7 +101,8 @@ template<Numeric T>
 VecBuffer<T>::VecBuffer(VecBuffer<T>&& other) noexcept : Buffer(std::move(other)) {
   target_ = other.target_;
   usage_ = other.usage_;
-  data_ = other.data_;
+  chunks_ = std::move(other.chunks_);
+  capacity_ = other.capacity_;
   front_ = other.front_;
   back_ = other.back_;
   fill_reverse_ = other.fill_reverse_;
@@ -82,7 +111,8 @@ VecBuffer<T>::VecBuffer(VecBuffer<T>&& other) noexcept : Buffer(std::move(other)
 
   other.target_ = BufTarget::none;
   other.usage_ = BufUsage::none;
-  other.data_.clear();
+  other.chunks_.clear();
+  other.capacity_ = 0;
   other.front_ = 0;
   other.back_ = 0;
   other.fill_reverse_ = false;
@@ -97,7 +127,8 @@ VecBuffer<T>& VecBuffer<T>::operator=(VecBuffer<T>&& other) noexcept {
 
     target_ = other.target_;
     usage_ = other.usage_;
-    data_ = other.data_;
+    chunks_ = std::move(other.chunks_);
+    capacity_ = other.capacity_;
     front_ = other.front_;
     back_ = other.back_;
     fill_reverse_ = other.fill_reverse_;
@@ -106,7 +137,8 @@ VecBuffer<T>& VecBuffer<T>::operator=(VecBuffer<T>&& other) noexcept {
 
     other.target_ = BufTarget::none;
     other.usage_ = BufUsage::none;
-    other.data_.clear();
+    other.chunks_.clear();
+    other.capacity_ = 0;
     other.front_ = 0;
     other.back_ = 0;
     other.fill_reverse_ = false;
@@ -119,8 +151,8 @@ VecBuffer<T>& VecBuffer<T>::operator=(VecBuffer<T>&& other) noexcept {
 template<Numeric T>
 void VecBuffer<T>::clear() {
   if (fill_reverse_) {
-    front_ = data_.size();
-    back_ = data_.size();
+    front_ = capacity_;
+    back_ = capacity_;
     gl_bufpos_ = front_;
   } else {
     front_ = 0u;
@@ -141,7 +173,48 @@ std::size_t VecBuffer<T>::size() const {
 
 template<Numeric T>
 std::size_t VecBuffer<T>::capacity() const {
-  return data_.size();
+  return capacity_;
+}
+
+template<Numeric T>
+std::size_t VecBuffer<T>::cpu_bytes() const {
+  return sizeof(T) * capacity_;
+}
+
+template<Numeric T>
+std::size_t VecBuffer<T>::gpu_bytes() const {
+  return sizeof(T) * gl_bufsize_;
+}
+
+template<Numeric T>
+void VecBuffer<T>::shrink(std::size_t capacity) {
+  // grow_ doubles, so it needs something to double
+  capacity = std::max({capacity, size(), std::size_t{1}});
+  if (capacity >= capacity_)
+    return;
+
+  // Everything that's left goes into one chunk
+  const auto n = size();
+  auto data = std::make_unique_for_overwrite<T[]>(capacity);
+  auto* dst = fill_reverse_ ? data.get() + capacity - n : data.get();
+  for_range_(front_, back_, [&](T* p, std::size_t, std::size_t count) {
+    dst = std::copy_n(p, count, dst);
+  });
+
+  chunks_.clear();
+  chunks_.emplace_back(std::move(data), capacity);
+  capacity_ = capacity;
+  if (fill_reverse_) {
+    front_ = capacity - n;
+    back_ = capacity;
+  }
+
+  if (gl_bufsize_ > 0) {
+    bind(target_);
+    gl.BufferData(unwrap(target_), 0, nullptr, unwrap(usage_));
+    unbind(target_);
+    gl_bufsize_ = 0;
+  }
 }
 
 template<Numeric T>
@@ -162,38 +235,25 @@ void VecBuffer<T>::add(const R& new_data) {
 
 template<Numeric T>
 void VecBuffer<T>::sync() {
-  if (gl_bufsize_ < data_.size()) {
+  if (gl_bufsize_ < capacity_) {
+    // Orphan the old store, only the live range has to go up
     bind(target_);
-    gl.BufferData(
-      unwrap(target_),
-      sizeof(T) * data_.size(),
-      &data_[0],
-      unwrap(usage_)
-    );
+    gl.BufferData(unwrap(target_), sizeof(T) * capacity_, nullptr, unwrap(usage_));
+    upload_(front_, back_);
     unbind(target_);
 
-    gl_bufsize_ = data_.size();
+    gl_bufsize_ = capacity_;
     gl_bufpos_ = fill_reverse_ ? front_ : back_;
   } else {
     if (fill_reverse_ && gl_bufpos_ > front_) {
       bind(target_);
-      gl.BufferSubData(
-        unwrap(target_),
-        sizeof(T) * front_,
-        sizeof(T) * (gl_bufpos_ - front_),
-        &data_[0] + front_
-      );
+      upload_(front_, gl_bufpos_);
       unbind(target_);
 
       gl_bufpos_ = front_;
     } else if (!fill_reverse_ && gl_bufpos_ < back_) {
       bind(target_);
-      gl.BufferSubData(
-        unwrap(target_),
-        sizeof(T) * gl_bufpos_,
-        sizeof(T) * (back_ - gl_bufpos_),
-        &data_[0] + gl_bufpos_
-      );
+      upload_(gl_bufpos_, back_);
       unbind(target_);
 
       gl_bufpos_ = back_;
@@ -201,23 +261,65 @@ void VecBuffer<T>::sync() {
   }
 }
 
+template<Numeric T>
+void VecBuffer<T>::grow_(std::size_t size) {
+  if (size == 0)
+    return;
+
+  Chunk_ chunk{std::make_unique_for_overwrite<T[]>(size), size};
+  if (fill_reverse_) {
+    chunks_.insert(chunks_.begin(), std::move(chunk));
+    front_ += size;
+    back_ += size;
+  } else
+    chunks_.emplace_back(std::move(chunk));
+  capacity_ += size;
+}
+
+template<Numeric T>
+template<typename F>
+void VecBuffer<T>::for_range_(std::size_t first, std::size_t last, F&& f) {
+  std::size_t chunk_start = 0;
+  for (auto& c: chunks_) {
+    if (first >= last)
+      break;
+
+    const auto chunk_end = chunk_start + c.size;
+    if (first < chunk_end) {
+      const auto count = std::min(last, chunk_end) - first;
+      f(c.data.get() + (first - chunk_start), first, count);
+      first += count;
+    }
+    chunk_start = chunk_end;
+  }
+}
+
+template<Numeric T>
+void VecBuffer<T>::upload_(std::size_t first, std::size_t last) {
+  for_range_(first, last, [&](T* p, std::size_t pos, std::size_t count) {
+    gl.BufferSubData(unwrap(target_), sizeof(T) * pos, sizeof(T) * count, p);
+  });
+}
+
 template<Numeric T>
 template<typename InputIt>
 void VecBuffer<T>::add_(InputIt begin, InputIt end) {
   std::size_t size = std::distance(begin, end);
   if (fill_reverse_) {
-    while (front_ + 1 <= size) {
-      front_ += data_.size();
-      back_ += data_.size();
-      data_.reserve(data_.size() * 2);
-      std::copy(data_.begin(), data_.end(), std::back_inserter(data_));
-    }
+    if (front_ < size)
+      grow_(std::max(capacity_, size - front_));
     front_ -= size;
-    std::copy(begin, end, data_.begin() + front_);
+    for_range_(front_, front_ + size, [&](T* p, std::size_t, std::size_t count) {
+      std::copy_n(begin, count, p);
+      std::advance(begin, count);
+    });
   } else {
-    while (back_ + size >= data_.size())
-      data_.resize(data_.size() * 2);
-    std::copy(begin, end, data_.begin() + back_);
+    if (back_ + size > capacity_)
+      grow_(std::max(capacity_, back_ + size - capacity_));
+    for_range_(back_, back_ + size, [&](T* p, std::size_t, std::size_t count) {
+      std::copy_n(begin, count, p);
+      std::advance(begin, count);
+    });
     back_ += size;
   }
 }
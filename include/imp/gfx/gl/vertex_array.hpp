@@ -4,12 +4,14 @@
 #include "imp/gfx/module/gfx_context.hpp"
 #include "imp/gfx/gl/buffer.hpp"
 #include "imp/gfx/gl/shader.hpp"
+#include "imp/gfx/gl/vertex_layout.hpp"
 #include <string>
 
 namespace imp {
 enum class DrawMode : unsigned int {
   none = 0, // Used as sentinel
   tex = 0xdeadbeef, // Used for batching
+  sprite = 0xdeadbef0, // Used for batching pulled sprites
 
   points = GL_POINTS,
   //  line_strip = GL_LINE_STRIP,
@@ -22,11 +24,20 @@ enum class DrawMode : unsigned int {
 
 class VertexArray {
 public:
+  GfxContext& ctx;
   GladGLContext& gl;
 
   GLuint id{0};
 
   explicit VertexArray(GfxContext& gfx);
+  ~VertexArray();
+
+  // Copy constructors don't make sense for OpenGL objects
+  VertexArray(const VertexArray&) = delete;
+  VertexArray& operator=(const VertexArray&) = delete;
+
+  VertexArray(VertexArray&& other) noexcept;
+  VertexArray& operator=(VertexArray&& other) noexcept;
 
   void bind();
   void unbind();
@@ -47,12 +58,21 @@ public:
   void attrib(Shader& shader, BufTarget target, Buffer& buf, const std::string& desc);
   void attrib(Shader& shader, Buffer& buf, const std::string& desc);
 
+  // Same as above, but everything but the locations was worked out at compile time, see
+  // vertex_layout.hpp. Prefer this for anything set up more than once
+  void attrib(Shader& shader, BufTarget target, Buffer& buf, const VertexLayout& layout);
+  void attrib(Shader& shader, Buffer& buf, const VertexLayout& layout);
+
   void element_array(Buffer& buf);
 
   void draw_arrays(const DrawMode& mode, GLsizei count, int first = 0);
 
   void multi_draw_arrays_indirect(const DrawMode& mode, GLsizei drawcount, GLsizei stride);
 
+  // Reads drawcount DrawElementsIndirectCommands from the bound GL_DRAW_INDIRECT_BUFFER, starting
+  // offset bytes in. Indices are always GL_UNSIGNED_INT
+  void multi_draw_elements_indirect(const DrawMode& mode, GLsizei drawcount, GLsizei stride, std::size_t offset = 0);
+
 private:
   struct VertexAttrib_ {
     GLuint index;
@@ -0,0 +1,121 @@
+#ifndef IMP_GFX_GL_VERTEX_LAYOUT_HPP
+#define IMP_GFX_GL_VERTEX_LAYOUT_HPP
+
+#include "imp/gfx/module/gfx_context.hpp"
+#include "glm/glm.hpp"
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+namespace imp {
+// GL_MAX_VERTEX_ATTRIBS is at least this everywhere
+inline constexpr std::size_t VERTEX_LAYOUT_MAX_ATTRIBS = 16;
+
+// The component count and GL type for each type a vertex field can have. Integer fields feed
+// int/uint shader inputs unless they're normalized, then they arrive as floats
+template<typename T>
+struct VertexAttribType;
+
+template<>
+struct VertexAttribType<float> {
+  static constexpr GLint size = 1;
+  static constexpr GLenum type = GL_FLOAT;
+};
+
+template<>
+struct VertexAttribType<int> {
+  static constexpr GLint size = 1;
+  static constexpr GLenum type = GL_INT;
+};
+
+template<>
+struct VertexAttribType<unsigned int> {
+  static constexpr GLint size = 1;
+  static constexpr GLenum type = GL_UNSIGNED_INT;
+};
+
+template<>
+struct VertexAttribType<std::int16_t> {
+  static constexpr GLint size = 1;
+  static constexpr GLenum type = GL_SHORT;
+};
+
+template<glm::length_t L, typename T, glm::qualifier Q>
+struct VertexAttribType<glm::vec<L, T, Q>> {
+  static constexpr GLint size = L;
+  static constexpr GLenum type = VertexAttribType<T>::type;
+};
+
+template<typename T>
+concept VertexAttribValue = requires {
+  VertexAttribType<T>::size;
+  VertexAttribType<T>::type;
+};
+
+struct VertexAttribDesc {
+  const char* name{nullptr};
+  GLint size{0};
+  GLenum type{GL_NONE};
+  GLboolean normalized{GL_FALSE};
+  GLsizei offset{0};
+  GLuint divisor{0};
+};
+
+// Everything VertexArray::attrib needs to point a shader's inputs at a buffer, worked out at
+// compile time by vertex_layout. Keep them as constexpr variables: shaders cache their attrib
+// locations by the layout's address
+struct VertexLayout {
+  std::array<VertexAttribDesc, VERTEX_LAYOUT_MAX_ATTRIBS> attribs{};
+  std::size_t count{0};
+  GLsizei stride{0};
+};
+
+template<typename V>
+struct VertexField {
+  VertexAttribDesc desc;
+  std::size_t bytes;
+};
+
+// One field of a vertex struct, fed to the shader input called name
+template<typename V, VertexAttribValue T>
+consteval VertexField<V> vertex_attrib(const char* name, T V::*, GLuint divisor = 0, bool normalized = false) {
+  const auto norm = static_cast<GLboolean>(normalized ? GL_TRUE : GL_FALSE);
+  return {{name, VertexAttribType<T>::size, VertexAttribType<T>::type, norm, 0, divisor}, sizeof(T)};
+}
+
+// Fields are listed in declaration order and packed one after the other, anything that doesn't
+// add up to sizeof(V) (a missing field, padding) won't compile
+//
+// Ex:
+//   struct ColorVertex {
+//     glm::vec3 pos;
+//     glm::vec4 color;
+//   };
+//   inline constexpr VertexLayout COLOR_VERTEX = vertex_layout<ColorVertex>(
+//     vertex_attrib("in_pos", &ColorVertex::pos),
+//     vertex_attrib("in_color", &ColorVertex::color)
+//   );
+template<typename V, typename... Fs>
+consteval VertexLayout vertex_layout(const Fs&... fields) {
+  static_assert(sizeof...(Fs) > 0 && sizeof...(Fs) <= VERTEX_LAYOUT_MAX_ATTRIBS);
+  static_assert((std::is_same_v<Fs, VertexField<V>> && ...), "Every field must belong to the vertex type");
+
+  VertexLayout layout{};
+  std::size_t offset = 0;
+  for (const auto& f: {fields...}) {
+    layout.attribs[layout.count] = f.desc;
+    layout.attribs[layout.count].offset = static_cast<GLsizei>(offset);
+    offset += f.bytes;
+    layout.count++;
+  }
+
+  // Throwing here is what turns a mismatch into a compile error
+  if (offset != sizeof(V))
+    throw "Vertex fields don't cover the whole vertex (or it's padded)";
+
+  layout.stride = static_cast<GLsizei>(sizeof(V));
+  return layout;
+}
+} // namespace imp
+
+#endif//IMP_GFX_GL_VERTEX_LAYOUT_HPP
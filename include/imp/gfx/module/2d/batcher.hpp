@@ -2,77 +2,311 @@
 #define IMP_GFX_MODULE_BATCHER_HPP
 
 #include "../../../core/module_mgr.hpp"
+#include "../../../util/averagers.hpp"
+#include "../../gl/quad_index_buffer.hpp"
+#include "../../gl/render_cmd.hpp"
+#include "../../gl/static_buffer.hpp"
+#include "../../gl/tex_image.hpp"
 #include "../../gl/vec_buffer.hpp"
 #include "../../gl/vertex_array.hpp"
+#include "../../gl/vertex_layout.hpp"
+#include "../../vertex_transform.hpp"
 #include "../shader_mgr.hpp"
+#include <span>
 
 namespace imp {
+// Floats of vertex data in a batch before its BatchList starts another in the same storage
 inline constexpr std::size_t BATCH_SIZE_LIMIT = 600'000;
-using DrawCall = std::function<void(GladGLContext&, glm::mat4, float)>;
 
+// Frames of batch storage in flight. Each frame records and uploads into its own set of buffers,
+// so nothing written this frame touches a buffer the driver may still be reading for the last one
+inline constexpr std::size_t BATCH_STORAGE_SETS = 2;
+
+// Batch storage is trimmed down towards the most it held in any one frame over this many frames,
+// and batches that held nothing at all for that long are released
+inline constexpr std::size_t BATCH_TRIM_WINDOW = 600;
+
+// Uniform buffer binding for the Frame block (projection and z_max) every batcher shader reads
+inline constexpr GLuint BATCH_FRAME_BINDING = 0;
+
+// Vertex formats the batcher shaders take, in_trans is (pivot.x, pivot.y, angle) with the angle in
+// radians. Points don't rotate, so they share the flat layout that CPU transformed vertices use
+struct BatchFlatVertex {
+  glm::vec3 pos;
+  glm::vec4 color;
+};
+
+struct BatchVertex {
+  glm::vec3 pos;
+  glm::vec4 color;
+  glm::vec3 trans;
+};
+
+// The third texture coordinate is the layer index (ignored for plain 2D textures)
+struct BatchFlatTexVertex {
+  glm::vec3 pos;
+  glm::vec4 color;
+  glm::vec3 tex_coords;
+};
+
+struct BatchTexVertex {
+  glm::vec3 pos;
+  glm::vec4 color;
+  glm::vec3 tex_coords;
+  glm::vec3 trans;
+};
+
+inline constexpr VertexLayout BATCH_FLAT_VERTEX = vertex_layout<BatchFlatVertex>(
+  vertex_attrib("in_pos", &BatchFlatVertex::pos),
+  vertex_attrib("in_color", &BatchFlatVertex::color)
+);
+
+inline constexpr VertexLayout BATCH_VERTEX = vertex_layout<BatchVertex>(
+  vertex_attrib("in_pos", &BatchVertex::pos),
+  vertex_attrib("in_color", &BatchVertex::color),
+  vertex_attrib("in_trans", &BatchVertex::trans)
+);
+
+inline constexpr VertexLayout BATCH_FLAT_TEX_VERTEX = vertex_layout<BatchFlatTexVertex>(
+  vertex_attrib("in_pos", &BatchFlatTexVertex::pos),
+  vertex_attrib("in_color", &BatchFlatTexVertex::color),
+  vertex_attrib("in_tex_coords", &BatchFlatTexVertex::tex_coords)
+);
+
+inline constexpr VertexLayout BATCH_TEX_VERTEX = vertex_layout<BatchTexVertex>(
+  vertex_attrib("in_pos", &BatchTexVertex::pos),
+  vertex_attrib("in_color", &BatchTexVertex::color),
+  vertex_attrib("in_tex_coords", &BatchTexVertex::tex_coords),
+  vertex_attrib("in_trans", &BatchTexVertex::trans)
+);
+
+// Vertices are handed to the batcher as flat float data
+constexpr std::size_t floats_per_vertex(const VertexLayout& layout) {
+  return static_cast<std::size_t>(layout.stride) / sizeof(float);
+}
+
+// One storage set of a BatchList, shared by every batch in it
+struct BatchStorage {
+  VertexArray vao;
+  FVBuffer vbo;
+  UVBuffer ebo;
+  std::optional<VertexArray> quad_vao;
+};
+
+// A run of the vertices and indices in a BatchList's storage. Indices are relative to the batch's
+// first vertex and drawn with that as the base vertex, so every batch in a list draws from the
+// same VAO and their draws can be folded into one multi-draw
+//
+// With a quad index buffer (and not filling in reverse), a batch starts every frame in quad mode:
+// while nothing but quads are added only their vertices are stored, and draws use the shared
+// indices. The first primitive that isn't a quad writes out real indices for the quads so far,
+// and the batch carries on normally until it's cleared
 class Batch {
 public:
-  Batch(
-    GfxContext& ctx, Shader& shader,
-    DrawMode draw_mode, const std::string& attrib_desc,
-    std::size_t vertices_per_obj, std::size_t floats_per_vertex, bool fill_reverse
-  );
+  Batch(DrawMode draw_mode, std::size_t fpv, bool fill_reverse);
+
+  // Start the batch at the current end of s
+  void begin(const BatchStorage& s);
 
+  // Floats of vertex data in the batch
   std::size_t size() const;
-  void clear();
 
-  void add(std::initializer_list<float> data, std::initializer_list<unsigned int> indices, bool insert_restart);
+  void add(BatchStorage& s, std::span<const float> data, std::span<const unsigned int> indices, bool insert_restart);
 
-  DrawCall get_draw_call_tex(GLuint id);
-  DrawCall get_draw_call();
+  // Quads drawn from the shared index buffer, including ranges recorded before leaving quad mode
+  std::size_t quads() const;
 
-private:
-  Shader& shader_;
-  VertexArray vao_;
-  FVBuffer vbo_;
-  UVBuffer ebo_;
-  unsigned int ebo_offset_{0};
+  // Record the draw for everything added since the last call (or the whole batch if it fills
+  // in reverse)
+  void record(const BatchStorage& s, RenderCmdBuffer& cmds);
 
+private:
   DrawMode draw_mode_;
   std::size_t floats_per_vertex_;
   bool fill_reverse_;
-  int draw_start_offset_{0};
+
+  GLint base_vertex_{0};
+  unsigned int vertex_count_{0};
+
+  // Indices from earlier batches, and this one's. Counted rather than kept as positions, since
+  // growing an ebo that fills in reverse moves everything in it
+  std::size_t indices_before_{0};
+  std::size_t indices_{0};
+  std::size_t draw_start_offset_{0};
+
+  bool quads_only_{false};
+  std::size_t quads_{0};
+
+  std::size_t index_count_() const;
 };
 
 class BatchList {
 public:
   BatchList(
     GfxContext& ctx, Shader& shader,
-    DrawMode draw_mode, const std::string& attrib_desc,
-    std::size_t vertices_per_obj, std::size_t floats_per_vertex, bool fill_reverse
+    DrawMode draw_mode, const VertexLayout& layout,
+    std::size_t vertices_per_obj, bool fill_reverse,
+    TexTarget tex_target = TexTarget::tex_2d, QuadIndexBuffer* quad_ebo = nullptr
   );
 
   std::size_t size() const;
   void clear();
 
-  void add_tex(GLuint id, std::initializer_list<float> data, std::initializer_list<unsigned int> indices, bool insert_restart);
-  void add(std::initializer_list<float> data, std::initializer_list<unsigned int> indices, bool insert_restart);
+  void add_tex(GLuint id, std::span<const float> data, std::span<const unsigned int> indices, bool insert_restart);
+  void add(std::span<const float> data, std::span<const unsigned int> indices, bool insert_restart);
 
-  std::vector<DrawCall> get_draw_calls_tex(GLuint id);
-  std::vector<DrawCall> get_draw_calls();
+  // Upload any pending vertex/index data, must happen before recorded commands are executed
+  void sync();
 
-private:
-  GfxContext& ctx_;
+  // Batches that filled up earlier in the frame are recorded first, unless reverse is set
+  void record(RenderCmdBuffer& cmds, GLuint tex_id = 0, bool reverse = false);
+
+  // Move on to the next storage set, clear it, and shrink it if it's grown well past what the
+  // trim window needed. The set just drawn is left alone. Returns how many batches were
+  // released for going unused over the whole window
+  std::size_t swap();
+
+  std::size_t cpu_bytes() const;
+  std::size_t gpu_bytes() const;
 
+private:
   Shader& shader_;
+  Uniform<glm::mat4> model_{};
+
+  std::vector<BatchStorage> sets_{};
+  std::size_t set_{0};
 
   std::vector<Batch> batches_{};
   std::size_t curr_batch_{0};
-  std::vector<DrawCall> stored_draw_calls_{};
+  std::vector<std::size_t> stored_batches_{};
 
-  DrawMode draw_mode_;
-  std::size_t vertices_per_obj_;
-  std::string attrib_desc_;
+  std::size_t initial_vertices_, initial_indices_;
+  std::size_t frame_vertices_{0}, frame_indices_{0}, frame_batches_{0}; // most held at once this frame
+  WindowMax vertex_peak_{BATCH_TRIM_WINDOW};
+  WindowMax index_peak_{BATCH_TRIM_WINDOW};
+  WindowMax batch_peak_{BATCH_TRIM_WINDOW};
 
+  DrawMode draw_mode_;
   std::size_t floats_per_vertex_;
   bool fill_reverse_;
+  TexTarget tex_target_;
+  QuadIndexBuffer* quad_ebo_;
+
+  BatchStorage& storage_();
+  const BatchStorage& storage_() const;
+
+  void trim_();
 };
 
+// CPU-side stream of primitives, so geometry can be generated off the GL thread
+// While a Scope is alive, every Batcher::add_* call made on that thread goes into the
+// recorder instead, and Batcher::current_z() hands out the recorder's own z values. z starts
+// at 0 for every recorder, and is rebased onto the batcher's z when it gets merged, so the
+// result doesn't depend on how the threads were scheduled
+class BatchRecorder {
+public:
+  class Scope {
+  public:
+    explicit Scope(BatchRecorder& recorder);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    BatchRecorder* prev_;
+  };
+
+  float z{0.0f};
+
+  std::size_t size() const;
+  void clear();
+
+  // True while a StaticBatch is being recorded on this thread. Its geometry outlives the
+  // frame, so it can't be judged by what's on screen right now
+  static bool retaining();
+
+private:
+  friend class Batcher;
+  friend class StaticBatch;
+
+  static thread_local BatchRecorder* active_;
+  bool retained_{false};
+
+  struct Prim_ {
+    DrawMode mode;
+    bool trans;
+    TexTarget tex_target;
+    GLuint tex_id;
+    bool insert_restart;
+    std::size_t v_first, v_count;
+    std::size_t i_first, i_count;
+  };
+
+  std::vector<Prim_> prims_{};
+  std::vector<float> vertices_{};
+  std::vector<unsigned int> indices_{};
+
+  void add_(DrawMode mode, bool trans, TexTarget target, GLuint id,
+            std::span<const float> data, std::span<const unsigned int> indices, bool insert_restart);
+};
+
+// Geometry that's recorded once and then stays on the GPU, drawn with Batcher::add_static
+// Opaque primitives are merged by state, transparent ones keep their order, so most batches
+// end up as a single draw. Nothing is uploaded again until the batch is re-recorded
+//
+// Ex:
+//   if (!bg->valid()) {
+//     auto scope = bg->record();
+//     ... gfx calls ...
+//   }
+//   batcher->add_static(*bg);
+class StaticBatch {
+public:
+  // Start over, until the scope ends every Batcher::add_* call on this thread goes into
+  // the batch. The upload happens the next time the batch is added
+  BatchRecorder::Scope record();
+
+  // Mark the batch as needing to be recorded again
+  void invalidate();
+  bool valid() const;
+
+  // How many z values the batch takes up when it's drawn
+  std::size_t z_span() const;
+
+private:
+  friend class Batcher;
+
+  struct Group_ {
+    DrawMode mode;
+    bool trans;
+    TexTarget tex_target;
+    GLuint tex_id;
+    GLuint program;
+    Uniform<glm::mat4> model;
+    VertexArray vao;
+    FSBuffer vbo;
+    USBuffer ebo; // empty when the group is all quads and draws from the shared quad indices
+    GLsizei count;
+  };
+
+  BatchRecorder recorder_{};
+  std::vector<Group_> groups_{};
+  std::size_t z_span_{0};
+  bool valid_{false};
+  bool dirty_{false};
+};
+
+// One sprite on the vertex pulling path, laid out the way textures_pulled.glsl reads it (std430)
+struct SpriteRecord {
+  glm::vec4 rect;  // x, y, w, h
+  glm::vec2 pivot; // rotation center
+  float angle;     // radians
+  float z;
+  glm::vec4 color;
+};
+static_assert(sizeof(SpriteRecord) == 12 * sizeof(float));
+
 class Batcher : public Module<Batcher> {
 public:
   float z{1.0f};
@@ -82,18 +316,95 @@ public:
 
   explicit Batcher(const std::weak_ptr<ModuleMgr>& module_mgr);
 
+  // In sorted mode primitives are recorded with a 64-bit sort key instead of going straight
+  // into the batches, and are radix sorted once per frame at the start of draw()
+  //   - Opaque primitives are grouped by state and ordered front to back within each group
+  //   - Transparent primitives keep their back to front order, but a primitive is allowed to
+  //     jump back into an earlier batch with the same state if it doesn't overlap anything
+  //     drawn in between, which avoids fragmenting interleaved primitives into tiny draws
+  void set_sorted(bool sorted);
+  bool is_sorted() const;
+
+  // Runs of draws that share a VAO and state are submitted with one glMultiDrawElementsIndirect
+  // instead of a DrawElements each. On by default when the context supports it
+  void set_multi_draw(bool multi_draw);
+  bool is_multi_draw() const;
+
+  // Sprites are stored as one SpriteRecord each in a shader storage buffer and expanded into
+  // corners by the vertex shader, instead of as 4 vertices and 6 indices. Needs GL 4.3
+  void set_vertex_pulling(bool vertex_pulling);
+  bool is_vertex_pulling() const;
+
+  // Rotations are baked into vertex positions on the CPU as primitives are batched, so the
+  // batches drop in_trans (12 bytes per vertex) and their shaders don't do any trig. Worth it
+  // where vertex shading is the bottleneck, like software rasterizers. Takes effect from the
+  // next frame, static batches always keep in_trans
+  void set_cpu_transform(bool cpu_transform);
+  bool is_cpu_transform() const;
+
+  // The z the next primitive added on this thread will get, use this instead of z when
+  // generating vertices so the same code works inside a BatchRecorder::Scope
+  float current_z() const;
+
+  // Hand out a recorder for this frame, only call this from the GL thread
+  // Recorders are merged in the order they were created, either by merge_recorders() or
+  // at the start of draw(), and are reused across frames
+  //
+  // Ex:
+  //   std::vector<BatchRecorder*> recs;
+  //   for (int i = 0; i < n; ++i) recs.emplace_back(&batcher->create_recorder());
+  //   #pragma omp parallel for
+  //   for (int i = 0; i < n; ++i) {
+  //     BatchRecorder::Scope scope(*recs[i]);
+  //     ... gfx calls ...
+  //   }
+  //   batcher->merge_recorders();
+  BatchRecorder& create_recorder();
+  void merge_recorders();
+
+  std::shared_ptr<StaticBatch> create_static();
+
+  // Draw a static batch as if its primitives were added here, uploading it first if it was
+  // just recorded. transform is applied to the batch's vertices before the projection, and
+  // z_offset shifts it in z relative to where it would otherwise go. Only call this from the GL thread
+  // NOTE: In sorted mode, transparent static groups draw before the sorted transparent primitives
+  void add_static(StaticBatch& batch, const glm::mat4& transform = glm::mat4(1.0f), float z_offset = 0.0f);
+
+  // Draw a static batch right now into whatever framebuffer is bound, on its own depth range
+  // and without touching anything queued for this frame. Only call this from the GL thread
+  void draw_static(StaticBatch& batch, const glm::mat4& projection);
+
   void add_opaque(const DrawMode& mode, std::initializer_list<float> data, std::initializer_list<unsigned int> indices, bool insert_restart = false);
   void add_trans(const DrawMode& mode, std::initializer_list<float> data, std::initializer_list<unsigned int> indices, bool insert_restart = false);
 
+  // For primitives whose vertex count isn't known up front (circles, polylines)
+  void add_opaque(const DrawMode& mode, std::span<const float> data, std::span<const unsigned int> indices, bool insert_restart = false);
+  void add_trans(const DrawMode& mode, std::span<const float> data, std::span<const unsigned int> indices, bool insert_restart = false);
+
+  // Textured vertices are laid out as BatchTexVertex
   void add_opaque_tex(GLuint id, std::initializer_list<float> data, std::initializer_list<unsigned int> indices);
   void add_trans_tex(GLuint id, std::initializer_list<float> data, std::initializer_list<unsigned int> indices);
 
+  void add_opaque_tex(TexTarget target, GLuint id, std::initializer_list<float> data, std::initializer_list<unsigned int> indices);
+  void add_trans_tex(TexTarget target, GLuint id, std::initializer_list<float> data, std::initializer_list<unsigned int> indices);
+
+  // A plain 2D texture stretched over rect and rotated by angle (radians) around pivot. Returns
+  // false without adding anything if the sprite can't be pulled right now (vertex pulling is off,
+  // sorted mode, or inside a BatchRecorder::Scope), the caller should add it as a quad instead
+  bool add_sprite(GLuint id, glm::vec4 rect, glm::vec2 pivot, float angle, const glm::vec4& color);
+
   void draw(const glm::mat4& projection);
 
+  // The commands issued by the last call to draw(), and what the executor made of them
+  // Only for inspecting, the batch storage they draw from is refilled next frame
+  const RenderCmdBuffer& opaque_commands() const;
+  const RenderCmdBuffer& trans_commands() const;
+  const RenderCmdStats& command_stats() const;
+
 private:
   /* PRIMITIVES */
   std::unordered_map<DrawMode, std::shared_ptr<Shader>> shaders_{};
-  std::unordered_map<DrawMode, std::string> attrib_descs_{};
+  std::unordered_map<DrawMode, const VertexLayout*> layouts_{};
   std::unordered_map<DrawMode, std::size_t> vertices_per_obj_{};
   std::unordered_map<DrawMode, std::size_t> floats_per_vertex_{};
 
@@ -102,21 +413,122 @@ private:
 
   /* TEXTURES */
   std::shared_ptr<Shader> tex_shader_{};
-  std::vector<BatchList> tex_batches_{};
+  std::shared_ptr<Shader> tex_array_shader_{};
+
+  // Keyed by GL texture id, for array textures every layer shares one batch
+  std::unordered_map<GLuint, BatchList> tex_batches_{};
 
   GLuint last_tex_id_{0};
 
+  /* CPU TRANSFORM */
+  std::unordered_map<DrawMode, std::shared_ptr<Shader>> flat_shaders_{};
+  std::shared_ptr<Shader> tex_flat_shader_{};
+  std::shared_ptr<Shader> tex_array_flat_shader_{};
+
+  bool cpu_transform_{false};
+  bool cpu_transform_next_{false};
+  VertexFlattener flattener_{};
+  std::vector<float> flat_vertices_{};
+
+  // Modes without in_trans (points) are passed through untouched
+  bool flat_(DrawMode mode) const;
+  std::span<const float> flatten_(std::span<const float> data, std::size_t fpv);
+
+  /* VERTEX PULLING */
+  std::shared_ptr<Shader> tex_pulled_shader_{};
+  Uniform<glm::mat4> tex_pulled_model_{};
+  std::optional<VertexArray> empty_vao_{}; // nothing to fetch, but a VAO still has to be bound to draw
+  std::optional<Buffer> sprite_ssbo_{};
+  std::size_t sprite_ssbo_capacity_{0};
+  bool vertex_pulling_{false};
+
+  // Every sprite this frame in the order it was added, runs with the same texture are one draw
+  std::vector<SpriteRecord> sprites_{};
+  std::size_t sprite_run_start_{0};
+  GLuint sprite_tex_id_{0};
+
+  void push_sprite_(GLuint id, const SpriteRecord& s);
+  void record_sprites_(RenderCmdBuffer& cmds);
+  void sync_sprites_();
+
+  /* RECORDERS */
+  std::vector<std::unique_ptr<BatchRecorder>> recorders_{};
+  std::size_t recorders_used_{0};
+
+  /* STATIC */
+  void build_static_(StaticBatch& batch);
+
+  /* SORTED */
+  struct SortItem_ {
+    std::uint64_t key;
+    std::uint32_t state;
+    DrawMode mode;
+    TexTarget tex_target;
+    GLuint tex_id;
+    bool insert_restart;
+    std::size_t v_first, v_count;
+    std::size_t i_first, i_count;
+    glm::vec4 bounds; // min x, min y, max x, max y
+  };
+
+  bool sorted_{false};
+  std::vector<SortItem_> sort_items_{};
+  std::vector<SortItem_> sort_scratch_{};
+  std::vector<float> sort_vertices_{};
+  std::vector<unsigned int> sort_indices_{};
+  std::unordered_map<GLuint, std::uint32_t> sort_tex_slots_{};
+
+  struct SortGroup_ {
+    std::uint32_t state;
+    glm::vec4 bounds;
+    std::vector<std::size_t> items;
+  };
+  std::vector<SortGroup_> sort_groups_{};
+
+  void record_(DrawMode mode, bool trans, TexTarget target, GLuint id,
+               std::span<const float> data, std::span<const unsigned int> indices, bool insert_restart);
+  void replay_sorted_();
+
   /* GENERAL */
   DrawMode last_trans_draw_mode_{DrawMode::none};
 
-  std::vector<DrawCall> opaque_draw_calls_{};
-  std::vector<DrawCall> trans_draw_calls_{};
+  void route_(DrawMode mode, bool trans, TexTarget target, GLuint id,
+              std::span<const float> data, std::span<const unsigned int> indices, bool insert_restart);
 
-  void collect_opaque_draw_calls_();
-  void collect_trans_draw_calls_();
+  void push_opaque_(DrawMode mode, std::span<const float> data, std::span<const unsigned int> indices, bool insert_restart);
+  void push_trans_(DrawMode mode, std::span<const float> data, std::span<const unsigned int> indices, bool insert_restart);
+  void push_trans_tex_(TexTarget target, GLuint id, std::span<const float> data, std::span<const unsigned int> indices);
+
+  // Shared by every batch that only holds quads
+  std::optional<QuadIndexBuffer> quad_ebo_{};
+
+  bool multi_draw_{true};
+  std::vector<UVBuffer> indirect_{}; // one per storage set, appended to by every execute in a frame
+
+  // Written once per pass in execute_, laid out as the std140 Frame block
+  std::optional<FSBuffer> frame_ubo_{};
+  std::vector<float> frame_block_ = std::vector<float>(20);
+
+  RenderCmdBuffer opaque_cmds_{};
+  RenderCmdBuffer trans_cmds_{};
+  RenderCmdBuffer last_opaque_cmds_{};
+  RenderCmdBuffer last_trans_cmds_{};
+  RenderCmdStats cmd_stats_{};
+
+  void record_opaque_();
+  void record_trans_();
+  void sync_();
+
+  // Sets up depth and blending around the two passes, and folds the commands first in multi-draw mode
+  RenderCmdStats execute_(RenderCmdBuffer& opaque, RenderCmdBuffer& trans, const glm::mat4& projection, float z_max);
 
   void clear_opaque_();
   void clear_trans_();
+
+  std::size_t storage_set_{0};
+  std::size_t batches_released_{0};
+
+  void r_end_frame_(const E_EndFrame& p);
 };
 } // namespace imp
 
@@ -4,20 +4,55 @@
 #include "imp/core/module_mgr.hpp"
 #include "imp/gfx/gl/enum_types.hpp"
 #include "imp/gfx/module/2d/batcher.hpp"
+#include "imp/gfx/module/font_mgr.hpp"
 #include "imp/gfx/module/gfx_context.hpp"
 #include "imp/gfx/module/texture_mgr.hpp"
+#include <atomic>
+#include <span>
 
 namespace imp {
+enum class LineJoin { miter, bevel, round };
+enum class LineCap { butt, square, round };
+
+// Miter joins longer than this many half-widths fall back to bevels
+inline constexpr float MITER_LIMIT = 4.0f;
+
 class Gfx2D : public Module<Gfx2D> {
 public:
   std::shared_ptr<Batcher> batcher{nullptr};
   std::shared_ptr<GfxContext> ctx{nullptr};
+  std::shared_ptr<FontMgr> fonts{nullptr};
   std::shared_ptr<TextureMgr> textures{nullptr};
 
   explicit Gfx2D(const std::weak_ptr<ModuleMgr>& module_mgr);
 
   void clear(const Color& color, const ClearBit& mask = ClearBit::color | ClearBit::depth);
 
+  /* CULLING */
+  // Primitives that are entirely outside the cull rect are dropped before they reach the batcher
+  // Bounds are conservative, anything rotated is bounded by a circle around its rcenter
+  // Nothing is culled while a StaticBatch is recording, it may be drawn anywhere later
+  void set_culling(bool enabled);
+  bool is_culling() const;
+
+  // The cull rect follows the window's projection unless one is set here, which is needed
+  // if the batcher is drawn with a different projection (a scrolling camera for example)
+  void set_cull_projection(const glm::mat4& projection);
+  void reset_cull_projection();
+
+  // Empty when following the window
+  std::optional<glm::mat4> cull_projection() const;
+
+  // min x, min y, max x, max y
+  glm::vec4 cull_rect() const;
+
+  // Bulk test of axis-aligned boxes in SoA form, visible[i] is set to 1 if box i might be on
+  // screen and 0 otherwise. This is a branchless loop over plain arrays so it vectorizes, and
+  // it doesn't touch the counters. Returns the number of visible boxes
+  std::size_t cull_boxes(std::span<const float> min_x, std::span<const float> min_y,
+                         std::span<const float> max_x, std::span<const float> max_y,
+                         std::span<std::uint8_t> visible) const;
+
   /* PRIMITIVES */
   void point(glm::vec2 xy, const Color& c);
 
@@ -41,13 +76,82 @@ public:
   void fill_rect(glm::vec2 xy, glm::vec2 size, float angle, const Color& c);
   void fill_rect(glm::vec2 xy, glm::vec2 size, const Color& c);
 
+  // Bulk variant, xy and size must be the same length
+  void fill_rect(std::span<const glm::vec2> xy, std::span<const glm::vec2> size, const Color& c);
+
+  /* SHAPES */
+  // Segment counts follow the radius on screen (so they account for set_cull_projection), and
+  // come from unit meshes built once per level of detail. There's no instanced path for them:
+  // the unit mesh is scaled into place on the CPU, so each shape still writes and uploads its
+  // own vertices, what's saved is the trig and the index pattern
+  void draw_circle(glm::vec2 center, float radius, const Color& c);
+  void fill_circle(glm::vec2 center, float radius, const Color& c);
+
+  // Angles are in degrees, clockwise from +x
+  void arc(glm::vec2 center, float radius, float start, float end, const Color& c);
+
+  void fill_rounded_rect(glm::vec2 xy, glm::vec2 size, float radius, glm::vec2 rcenter, float angle, const Color& c);
+  void fill_rounded_rect(glm::vec2 xy, glm::vec2 size, float radius, float angle, const Color& c);
+  void fill_rounded_rect(glm::vec2 xy, glm::vec2 size, float radius, const Color& c);
+
+  // Open polyline, submitted as a single primitive. Segment offsets are computed in one
+  // branchless pass over SoA arrays, joins and caps are filled in afterwards
+  // NOTE: Where a sharp turn makes neighbouring segments overlap on the inside, translucent
+  //       colors will blend twice
+  void polyline(std::span<const glm::vec2> points, float thickness, LineJoin join, LineCap cap, const Color& c);
+
   /* TEXTURES */
   void draw_tex(const Texture& t, glm::vec2 xy, glm::vec2 rcenter, float angle, const Color& c = rgb("white"));
   void draw_tex(const Texture& t, glm::vec2 xy, float angle, const Color& c = rgb("white"));
   void draw_tex(const Texture& t, glm::vec2 xy, const Color& c = rgb("white"));
 
+  // Bulk variant, draws t once at every position
+  void draw_tex(const Texture& t, std::span<const glm::vec2> xy, const Color& c = rgb("white"));
+
+  /* TEXT */
+  // xy is the top left of the text, size is the pixel height of a line. Glyphs come from the
+  // shared SDF atlas, so any size or scale stays sharp, and the whole string is one batch
+  // Only call these from the GL thread
+  void text(const Font& f, std::string_view s, glm::vec2 xy, float size, glm::vec2 rcenter, float angle, const Color& c = rgb("white"));
+  void text(const Font& f, std::string_view s, glm::vec2 xy, float size, float angle, const Color& c = rgb("white"));
+  void text(const Font& f, std::string_view s, glm::vec2 xy, float size, const Color& c = rgb("white"));
+
 private:
   static std::once_flag created_required_modules_;
+
+  /* CULLING */
+  bool culling_{false};
+  std::optional<glm::mat4> cull_projection_{};
+  glm::vec4 cull_rect_{};
+  float px_per_unit_{1.0f};
+
+  // Primitives may be submitted from BatchRecorder threads. Nothing is counted with culling off
+  std::atomic<std::size_t> frame_culled_{0};
+  std::atomic<std::size_t> frame_submitted_{0};
+  std::size_t last_culled_{0};
+  std::size_t last_submitted_{0};
+
+  void update_cull_rect_();
+  bool culling_active_() const;
+  bool visible_(std::initializer_list<glm::vec2> points, glm::vec2 rcenter, float angle);
+  bool visible_rect_(glm::vec2 xy, glm::vec2 size, glm::vec2 rcenter, float angle);
+  void count_(std::size_t submitted, std::size_t culled);
+
+  // Bulk scratch space, only touched from the GL thread
+  std::vector<float> bulk_bounds_{};
+  std::vector<std::uint8_t> bulk_visible_{};
+
+  /* SHAPES */
+  // Index into the unit circle LODs for a radius in world units
+  std::size_t circle_lod_(float radius) const;
+
+  void shape_(bool trans, DrawMode mode, std::span<const float> vertices, std::span<const unsigned int> indices, bool insert_restart = false);
+
+  void fill_rect_(glm::vec2 xy, glm::vec2 size, glm::vec2 rcenter, float angle, const Color& c);
+  void draw_tex_(const Texture& t, glm::vec2 xy, glm::vec2 rcenter, float angle, const Color& c);
+  void text_(const TextRun& run, glm::vec2 xy, glm::vec2 rcenter, float angle, const Color& c);
+
+  void r_start_frame_(const E_StartFrame& p);
 };
 } // namespace imp
 
@@ -0,0 +1,78 @@
+#ifndef IMP_GFX_MODULE_LAYER_MGR_HPP
+#define IMP_GFX_MODULE_LAYER_MGR_HPP
+
+#include "imp/core/module_mgr.hpp"
+#include "imp/gfx/gl/framebuffer.hpp"
+#include "imp/gfx/module/2d/batcher.hpp"
+#include "imp/gfx/module/2d/gfx_2d.hpp"
+#include <functional>
+#include <memory>
+
+namespace imp {
+// A region of the world that's drawn into its own texture once, then composited as a single quad
+// every frame until it's invalidated
+class RenderLayer {
+public:
+  RenderLayer(glm::vec4 region, glm::ivec2 resolution);
+
+  // x, y, w, h in world units
+  glm::vec4 region() const;
+
+  // Size of the backing texture in pixels
+  glm::ivec2 resolution() const;
+
+  // The contents are drawn again the next time the layer is drawn
+  void invalidate();
+  bool valid() const;
+
+  // Move the layer without redrawing it
+  void set_pos(glm::vec2 xy);
+
+private:
+  friend class LayerMgr;
+
+  glm::vec4 region_;
+  glm::ivec2 resolution_;
+
+  std::unique_ptr<Framebuffer> fbo_{nullptr};
+  bool valid_{false};
+};
+
+// Gfx2D must be created before this module
+//
+// Ex:
+//   if (hud_changed) hud->invalidate();
+//   layers->draw(*hud, [&] {
+//     ... gfx calls ...
+//   });
+class LayerMgr : public Module<LayerMgr> {
+public:
+  std::shared_ptr<Batcher> batcher{nullptr};
+  std::shared_ptr<Gfx2D> gfx{nullptr};
+
+  explicit LayerMgr(const std::weak_ptr<ModuleMgr>& module_mgr);
+
+  // resolution defaults to the region's size, so one world unit is one texel
+  std::shared_ptr<RenderLayer> create(glm::vec4 region, glm::ivec2 resolution = {0, 0});
+
+  // Composite the layer as one transparent quad over its region. If it isn't valid, build is
+  // called first and everything it draws through Gfx2D goes into the layer instead of the frame,
+  // with the region as the projection. Nothing is culled while building. Only call this from the
+  // GL thread
+  void draw(RenderLayer& layer, const std::function<void()>& build, const Color& c = rgb("white"));
+
+private:
+  std::size_t frame_hits_{0};
+  std::size_t frame_misses_{0};
+  std::size_t last_hits_{0};
+  std::size_t last_misses_{0};
+
+  void build_(RenderLayer& layer, const std::function<void()>& build);
+
+  void r_start_frame_(const E_StartFrame& p);
+};
+} // namespace imp
+
+IMP_PRAISE_HERMES(imp::LayerMgr);
+
+#endif//IMP_GFX_MODULE_LAYER_MGR_HPP
@@ -0,0 +1,141 @@
+#ifndef IMP_GFX_MODULE_PARTICLE_SYSTEM_HPP
+#define IMP_GFX_MODULE_PARTICLE_SYSTEM_HPP
+
+#include "imp/core/module_mgr.hpp"
+#include "imp/gfx/gl/buffer.hpp"
+#include "imp/gfx/gl/static_buffer.hpp"
+#include "imp/gfx/gl/vertex_array.hpp"
+#include "imp/gfx/module/shader_mgr.hpp"
+#include "imp/gfx/color.hpp"
+#include "glm/glm.hpp"
+#include <array>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace imp {
+enum class ParticleBackend {
+  gpu, // compute shaders, needs GL 4.3
+  cpu  // SoA arrays integrated in plain loops the compiler can vectorize
+};
+
+struct ParticleParams {
+  glm::vec2 lifetime{1.0f, 1.0f}; // min, max in seconds
+  glm::vec2 speed{50.0f, 100.0f}; // min, max
+  glm::vec2 angle{0.0f, 360.0f};  // min, max in degrees
+  glm::vec2 size{4.0f, 4.0f};     // at birth, at death
+  glm::vec2 gravity{0.0f, 0.0f};
+  float drag{0.0f};               // fraction of velocity lost per second
+
+  RGB color_start{rgb("white")};
+  RGB color_end{rgba("white", 0)};
+};
+
+// A fixed number of particle slots sharing one set of parameters. New particles take the next
+// slots in a ring, so once it's full the oldest are replaced first
+class ParticlePool {
+public:
+  ParticleParams params;
+
+  ParticlePool(GfxContext& gfx, std::size_t capacity, const ParticleParams& params, ParticleBackend backend);
+
+  std::size_t capacity() const;
+  ParticleBackend backend() const;
+
+  // Only known without a readback on the CPU backend, the GPU backend keeps the count on the GPU
+  std::optional<std::size_t> alive() const;
+
+private:
+  friend class ParticleSystem;
+
+  GfxContext& ctx_;
+  std::size_t capacity_;
+  ParticleBackend backend_;
+
+  struct Emit_ {
+    glm::vec2 xy;
+    float radius;
+    std::uint32_t first, count, seed;
+  };
+  std::vector<Emit_> pending_{};
+  std::size_t head_{0};
+  std::uint32_t seed_{0};
+
+  // Both backends draw from these
+  Buffer instances_;
+  Buffer draw_cmd_;
+  VertexArray vao_;
+  std::size_t alive_{0};
+
+  /* GPU */
+  std::array<std::optional<Buffer>, 6> fields_{};
+
+  /* CPU */
+  std::vector<float> px_{}, py_{}, vx_{}, vy_{}, age_{}, life_{};
+  std::vector<float> cpu_instances_{};
+};
+
+// Particles are simulated after Application::update every frame, and drawn on their own with
+// draw(), not through the Batcher
+//
+// Ex:
+//   sparks = particles->create(100'000, {.lifetime = {0.5f, 1.0f}, .gravity = {0, 400}});
+//   ...
+//   particles->emit(*sparks, cursor_xy, 500, 4.0f);
+//   ...
+//   batcher->draw(projection);
+//   particles->draw(*sparks, projection);
+class ParticleSystem : public Module<ParticleSystem> {
+public:
+  std::shared_ptr<GfxContext> ctx{nullptr};
+  std::shared_ptr<ShaderMgr> shaders{nullptr};
+
+  explicit ParticleSystem(const std::weak_ptr<ModuleMgr>& module_mgr);
+
+  // Falls back to the CPU backend if compute shaders aren't available
+  std::shared_ptr<ParticlePool> create(std::size_t capacity, const ParticleParams& params,
+                                       ParticleBackend backend = ParticleBackend::gpu);
+
+  // count is clamped to the pool's capacity
+  void emit(ParticlePool& pool, glm::vec2 xy, std::size_t count, float radius = 0.0f);
+
+  // Blended over whatever is in the framebuffer, without depth testing
+  void draw(ParticlePool& pool, const glm::mat4& projection);
+
+private:
+  std::shared_ptr<Shader> sim_shader_{nullptr};
+  std::shared_ptr<Shader> draw_shader_{nullptr};
+  bool compute_{false};
+
+  // Set every frame or once per emit, so they're looked up ahead of time
+  Uniform<unsigned int> emit_first_{}, emit_count_{}, emit_seed_{};
+  Uniform<glm::vec2> emit_pos_{};
+  Uniform<float> emit_radius_{};
+
+  Uniform<unsigned int> sim_capacity_{}, sim_mode_{};
+  Uniform<glm::vec2> sim_speed_{}, sim_angle_{}, sim_lifetime_{}, sim_gravity_{};
+  Uniform<float> sim_dt_{}, sim_damping_{};
+
+  Uniform<glm::mat4> draw_mvp_{};
+  Uniform<glm::vec2> draw_size_{};
+  Uniform<glm::vec4> draw_color_start_{}, draw_color_end_{};
+
+  // Unit quad shared by every pool, each particle is an instance of it
+  std::optional<FSBuffer> quad_vbo_{};
+  std::optional<USBuffer> quad_ebo_{};
+
+  std::vector<std::weak_ptr<ParticlePool>> pools_{};
+
+  double last_sim_ms_{0.0};
+  std::size_t last_cpu_alive_{0};
+
+  void simulate_gpu_(ParticlePool& pool, float dt);
+  void simulate_cpu_(ParticlePool& pool, float dt);
+
+  void r_update_(const E_Update& p);
+};
+} // namespace imp
+
+IMP_PRAISE_HERMES(imp::ParticleSystem);
+
+#endif//IMP_GFX_MODULE_PARTICLE_SYSTEM_HPP
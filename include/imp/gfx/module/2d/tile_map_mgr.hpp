@@ -0,0 +1,94 @@
+#ifndef IMP_GFX_MODULE_TILE_MAP_MGR_HPP
+#define IMP_GFX_MODULE_TILE_MAP_MGR_HPP
+
+#include "imp/core/module_mgr.hpp"
+#include "imp/gfx/module/2d/batcher.hpp"
+#include "imp/gfx/module/2d/gfx_2d.hpp"
+#include "imp/gfx/module/texture_mgr.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace imp {
+// Tiles are 1-based indices into the tileset, read left to right, top to bottom
+// 0 is an empty tile
+using TileId = std::uint16_t;
+inline constexpr TileId EMPTY_TILE = 0;
+
+// Width and height of a chunk, in tiles
+inline constexpr int TILE_CHUNK_SIZE = 32;
+
+// Chunks that haven't been drawn for this many frames give up their GPU buffers
+inline constexpr std::size_t TILE_CHUNK_EVICT_FRAMES = 120;
+
+class TileMap {
+public:
+  TileMap(glm::ivec2 size, std::shared_ptr<Texture> tileset, glm::ivec2 tile_size);
+
+  int w() const;
+  int h() const;
+  glm::ivec2 tile_size() const;
+
+  const std::shared_ptr<Texture>& tileset() const;
+
+  TileId get(int x, int y) const;
+
+  // Only the chunks containing changed tiles are rebuilt
+  void set(int x, int y, TileId tile);
+  void fill(TileId tile);
+
+private:
+  friend class TileMapMgr;
+
+  struct Chunk_ {
+    std::shared_ptr<StaticBatch> batch{nullptr};
+    bool dirty{true};
+    std::size_t last_drawn{0};
+  };
+
+  glm::ivec2 size_;
+  glm::ivec2 tile_size_;
+  std::shared_ptr<Texture> tileset_;
+
+  std::vector<TileId> tiles_{};
+
+  glm::ivec2 chunk_count_;
+  std::vector<Chunk_> chunks_{};
+
+  // Indices of chunks that currently hold GPU buffers
+  std::vector<std::size_t> resident_{};
+};
+
+// Gfx2D must be created before this module
+class TileMapMgr : public Module<TileMapMgr> {
+public:
+  std::shared_ptr<Batcher> batcher{nullptr};
+  std::shared_ptr<Gfx2D> gfx{nullptr};
+  std::shared_ptr<TextureMgr> textures{nullptr};
+
+  explicit TileMapMgr(const std::weak_ptr<ModuleMgr>& module_mgr);
+
+  std::shared_ptr<TileMap> create(glm::ivec2 size, std::shared_ptr<Texture> tileset, glm::ivec2 tile_size);
+
+  // Draw every chunk that overlaps Gfx2D's cull rect, with the map's top left corner at xy
+  // Chunks are built the first time they're seen and whenever their tiles change
+  void draw(TileMap& map, glm::vec2 xy = {0, 0});
+
+private:
+  std::size_t frame_{0};
+
+  std::size_t frame_chunks_drawn_{0};
+  std::size_t frame_chunks_built_{0};
+  std::size_t last_chunks_drawn_{0};
+  std::size_t last_chunks_built_{0};
+  std::size_t chunks_resident_{0};
+
+  void build_chunk_(TileMap& map, int cx, int cy);
+  void evict_(TileMap& map);
+
+  void r_start_frame_(const E_StartFrame& p);
+};
+} // namespace imp
+
+IMP_PRAISE_HERMES(imp::TileMapMgr);
+
+#endif//IMP_GFX_MODULE_TILE_MAP_MGR_HPP
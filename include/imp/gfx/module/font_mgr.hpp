@@ -0,0 +1,146 @@
+#ifndef IMP_GFX_MODULE_FONT_MGR_HPP
+#define IMP_GFX_MODULE_FONT_MGR_HPP
+
+#include "imp/core/module_mgr.hpp"
+#include "imp/gfx/gl/tex_image.hpp"
+#include "glm/glm.hpp"
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct stbtt_fontinfo;
+
+namespace imp {
+// Glyphs are rasterized once at this pixel height as signed distance fields, and scaled
+// to whatever size they're drawn at
+inline constexpr float FONT_SDF_SIZE = 32.0f;
+
+// Distance (in pixels at FONT_SDF_SIZE) covered by the field on either side of an edge
+inline constexpr int FONT_SDF_PADDING = 4;
+
+// Width and height of the glyph atlas shared by every font
+inline constexpr GLsizei FONT_ATLAS_SIZE = 1024;
+
+// Shaped runs that haven't been drawn for this many frames are dropped
+inline constexpr std::size_t FONT_RUN_EVICT_FRAMES = 300;
+
+class Font {
+public:
+  Font(const std::string& name, std::uint32_t id, std::vector<unsigned char> bytes);
+  ~Font();
+
+  Font(const Font&) = delete;
+  Font& operator=(const Font&) = delete;
+
+  std::string name() const;
+
+  // False if the file couldn't be parsed as a TrueType font
+  bool valid() const;
+
+  // Distance between baselines at the given pixel size
+  float line_height(float size) const;
+
+private:
+  friend class FontMgr;
+
+  std::string name_;
+  std::uint32_t id_;
+
+  // stbtt_fontinfo points into this, so it must never move
+  std::vector<unsigned char> bytes_;
+  std::unique_ptr<stbtt_fontinfo> info_;
+
+  // Metrics at FONT_SDF_SIZE
+  float scale_{0.0f};
+  float ascent_{0.0f};
+  float descent_{0.0f};
+  float line_gap_{0.0f};
+};
+
+// A laid out string, positions are relative to the top left of the text and UVs are in the atlas
+struct TextRun {
+  struct Quad {
+    glm::vec4 pos; // x0, y0, x1, y1
+    glm::vec4 uv;  // u0, v0, u1, v1
+  };
+
+  std::vector<Quad> quads{};
+  glm::vec2 size{0, 0};
+};
+
+class FontMgr : public Module<FontMgr> {
+public:
+  std::shared_ptr<GfxContext> ctx{nullptr};
+
+  explicit FontMgr(const std::weak_ptr<ModuleMgr>& module_mgr);
+
+  std::shared_ptr<Font> load(const std::string& name, const std::filesystem::path& path);
+  std::shared_ptr<Font> load(const std::filesystem::path& path);
+
+  // Lay out UTF-8 text at the given pixel size, '\n' starts a new line
+  // Runs are cached by font, size and text, so a string that doesn't change is only laid out
+  // once, and its glyphs are only rasterized the first time any run uses them
+  // The reference stays valid until the start of the next frame. Only call this from the GL thread
+  const TextRun& shape(const Font& font, std::string_view text, float size);
+
+  glm::vec2 measure(const Font& font, std::string_view text, float size);
+
+  // Single channel, sample it with a negative layer to get the SDF path in the textures shader
+  GLuint atlas_id() const;
+
+private:
+  std::unordered_map<std::string, std::shared_ptr<Font>> fonts_{};
+  std::uint32_t next_font_id_{1};
+
+  /* ATLAS */
+  struct Glyph_ {
+    glm::vec4 uv;
+    glm::vec2 offset; // from the pen position to the top left of the bitmap
+    glm::vec2 size;
+    float advance;
+    bool empty;
+  };
+
+  std::optional<TexImage> atlas_{};
+  std::unordered_map<std::uint64_t, Glyph_> glyphs_{};
+
+  // Shelf packing, glyphs are never moved once they're placed so cached runs stay valid
+  GLsizei shelf_x_{0};
+  GLsizei shelf_y_{0};
+  GLsizei shelf_h_{0};
+  bool atlas_full_{false};
+
+  const Glyph_& glyph_(const Font& font, int codepoint);
+  std::optional<glm::ivec2> pack_(GLsizei w, GLsizei h);
+
+  /* RUNS */
+  struct Run_ {
+    std::uint32_t font_id;
+    float size;
+    std::string text;
+    TextRun run;
+    std::size_t last_used;
+  };
+
+  // Keyed by a hash of font, size and text, the key fields are kept to catch collisions
+  std::unordered_map<std::uint64_t, Run_> runs_{};
+  std::size_t frame_{0};
+
+  std::size_t frame_hits_{0};
+  std::size_t frame_misses_{0};
+  std::size_t last_hits_{0};
+  std::size_t last_misses_{0};
+
+  void layout_(const Font& font, std::string_view text, float size, TextRun& run);
+
+  void r_start_frame_(const E_StartFrame& p);
+};
+} // namespace imp
+
+IMP_PRAISE_HERMES(imp::FontMgr);
+
+#endif//IMP_GFX_MODULE_FONT_MGR_HPP
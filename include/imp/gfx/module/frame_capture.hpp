@@ -0,0 +1,97 @@
+#ifndef IMP_GFX_MODULE_FRAME_CAPTURE_HPP
+#define IMP_GFX_MODULE_FRAME_CAPTURE_HPP
+
+#include "imp/core/module_mgr.hpp"
+#include "imp/gfx/gl/buffer.hpp"
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace imp {
+// Frames read back but not mapped yet, reads normally land 1-2 frames after they're issued
+inline constexpr std::size_t CAPTURE_RING_SIZE = 4;
+
+// Frames mapped but not encoded yet, past this new frames are dropped instead of piling up in memory
+inline constexpr std::size_t CAPTURE_QUEUE_MAX = 16;
+
+enum class CaptureFormat {
+  png,
+  raw // tightly packed RGBA8, top row first
+};
+
+// Reads the back buffer into a ring of pixel pack buffers at the start of E_EndFrame, so what's
+// captured is everything drawn that frame, minus the debug overlay and any other imgui windows
+// Nothing waits on the GPU: each read is only mapped once its fence has signalled, and the copy
+// is encoded and written on a worker thread
+class FrameCapture : public Module<FrameCapture> {
+public:
+  std::shared_ptr<GfxContext> ctx{nullptr};
+
+  explicit FrameCapture(const std::weak_ptr<ModuleMgr>& module_mgr);
+  ~FrameCapture() override;
+
+  // Save this frame as a PNG, or the first one after it that can be read back without stalling
+  void screenshot(const std::filesystem::path& path);
+
+  // Save every frame as <dir>/frame_000000.<png|rgba> until stopped, the directory is created if needed
+  void start_recording(const std::filesystem::path& dir, CaptureFormat format = CaptureFormat::png);
+  void stop_recording();
+  bool is_recording() const;
+
+private:
+  struct Job_ {
+    std::filesystem::path path;
+    CaptureFormat format;
+    int w, h;
+    std::vector<unsigned char> pixels; // bottom row first, as GL hands them back
+  };
+
+  struct Slot_ {
+    Buffer pbo;
+    std::size_t capacity{0};
+    GLsync fence{nullptr};
+    std::filesystem::path path{};
+    CaptureFormat format{CaptureFormat::png};
+    int w{0}, h{0};
+  };
+
+  std::vector<Slot_> slots_{};
+  std::size_t next_slot_{0};
+
+  std::optional<std::filesystem::path> screenshot_path_{};
+
+  struct {
+    bool active{false};
+    std::filesystem::path dir{};
+    CaptureFormat format{CaptureFormat::png};
+    std::size_t frame{0};
+  } recording_{};
+
+  /* WORKER */
+  std::mutex mutex_;
+  std::condition_variable_any cv_;
+  std::deque<Job_> jobs_{};
+  std::vector<std::vector<unsigned char>> spare_{};
+  std::jthread worker_;
+
+  std::size_t frames_captured_{0};
+  std::size_t frames_dropped_{0};
+
+  // False if nothing was read, either the window is minimized or every slot is busy
+  bool read_(const std::filesystem::path& path, CaptureFormat format);
+  void collect_(bool wait);
+
+  void work_(std::stop_token st);
+  static void encode_(const Job_& job);
+
+  void r_end_frame_(const E_EndFrame& p);
+};
+} // namespace imp
+
+IMP_PRAISE_HERMES(imp::FrameCapture);
+
+#endif//IMP_GFX_MODULE_FRAME_CAPTURE_HPP
@@ -10,8 +10,18 @@
 #include "glad/wgl.h"
 #endif
 #include "glm/vec2.hpp"
+#include <array>
+#include <optional>
+#include <unordered_map>
 
 namespace imp {
+class RenderTargetPool;
+
+struct GlCallStats {
+  std::size_t issued{0};
+  std::size_t elided{0};
+};
+
 class GfxContext : public Module<GfxContext> {
 public:
   std::shared_ptr<DebugOverlay> debug_overlay{nullptr};
@@ -22,6 +32,8 @@ public:
   GladGLContext gl;
   glm::ivec2 version{};
 
+  std::shared_ptr<RenderTargetPool> render_targets{nullptr};
+
   bool is_vsync() const;
   void set_vsync(bool v);
 
@@ -34,9 +46,73 @@ public:
 
   void depth_mask(bool enable);
 
+  void primitive_restart_index(GLuint index);
+
+  void viewport(GLint x, GLint y, GLsizei w, GLsizei h);
+
+  // x, y, w, h, only asks GL if the cache doesn't know yet
+  std::array<GLint, 4> viewport();
+
+  /* STATE CACHE */
+  // Binds go through a shadow copy of the GL state, and calls that wouldn't change
+  // anything are skipped. Each returns true if a GL call was actually made
+
+  bool use_program(GLuint id);
+  bool bind_vertex_array(GLuint id);
+  bool bind_buffer(GLenum target, GLuint id);
+  bool bind_texture(GLenum target, GLuint id, GLuint unit = 0);
+
+  // Indexed bindings aren't cached, this always issues but keeps the generic binding it
+  // replaces in sync
+  void bind_buffer_base(GLenum target, GLuint index, GLuint id);
+
+  // GL_FRAMEBUFFER sets both the draw and read bindings, returns true if either changed
+  bool bind_framebuffer(GLenum target, GLuint id);
+
+  // What's bound to GL_DRAW_FRAMEBUFFER or GL_READ_FRAMEBUFFER, only asks GL if the cache
+  // doesn't know yet
+  GLuint framebuffer(GLenum target);
+
+  // GL unbinds deleted objects, so the cache has to be told about deletions before
+  // the names get handed out again
+  void forget_program(GLuint id);
+  void forget_vertex_array(GLuint id);
+  void forget_buffer(GLuint id);
+  void forget_texture(GLuint id);
+  void forget_framebuffer(GLuint id);
+
+  // Anything that changes GL state without going through this context should call this
+  // afterwards, so the next call of each kind is issued unconditionally
+  void invalidate_state_cache();
+
+  // Counts from the last complete frame
+  const GlCallStats& gl_call_stats() const;
+
 private:
   WindowOpenParams initialize_params_;
 
+  std::optional<GLuint> program_{};
+  std::optional<GLuint> vertex_array_{};
+  std::unordered_map<GLenum, GLuint> buffers_{};
+  std::optional<GLuint> active_texture_unit_{};
+  std::unordered_map<GLuint, std::unordered_map<GLenum, GLuint>> textures_{};
+  std::optional<GLuint> draw_framebuffer_{};
+  std::optional<GLuint> read_framebuffer_{};
+  std::unordered_map<GLenum, bool> capabilities_{};
+  std::optional<std::array<GLenum, 4>> blend_funcs_{};
+  std::optional<bool> depth_mask_{};
+  std::optional<GLuint> primitive_restart_index_{};
+  std::optional<std::array<GLint, 4>> viewport_{};
+
+  GlCallStats frame_gl_calls_{};
+  GlCallStats last_frame_gl_calls_{};
+
+  bool issue_(bool needed);
+
+  void r_update_(const E_Update& p);
+  void r_end_frame_(const E_EndFrame& p);
+  void r_glfw_framebuffer_size_(const E_GlfwFramebufferSize& p);
+
   static void GLAPIENTRY gl_message_callback_(
     GLenum source,
     GLenum type,
@@ -4,9 +4,11 @@
 #include "imp/core/module_mgr.hpp"
 #include "imp/gfx/gl/shader.hpp"
 #include "imp/gfx/module/gfx_context.hpp"
+#include <filesystem>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace imp {
 class ShaderMgr : public Module<ShaderMgr> {
@@ -19,11 +21,50 @@ public:
 
   // Names must be unique, and a previously compiled shader will be returned if
   // a shader with that name has already been compiled (rather than recompiling)
+  // Linked programs are cached on disk, keyed by the source and the driver, so later runs
+  // can skip compiling them if the driver supports program binaries
   std::shared_ptr<Shader> compile(const std::string& name, const ShaderSrc& src);
   std::shared_ptr<Shader> compile(const ShaderSrc& src);
 
+  // ShaderSrc::parse, but every file read is kept along with the result. Nothing is read again
+  // until a file's modification time changes, so parsing an unchanged shader is a stat per file
+  std::optional<ShaderSrc> parse(const std::filesystem::path& path);
+
+  // Parse path again and recompile the named shader from it, unless the source hashes the same
+  // as what the shader was built from. False if there's no such shader or the file won't parse
+  bool reload(const std::string& name, const std::filesystem::path& path);
+
 private:
   std::unordered_map<std::string, std::shared_ptr<Shader>> shaders_{};
+
+  struct File_ {
+    std::filesystem::file_time_type mtime;
+    std::string text;
+  };
+  std::unordered_map<std::string, File_> files_{};
+
+  // Parsed shaders, along with every file that went into them as it was when read
+  struct Parsed_ {
+    std::vector<std::pair<std::filesystem::path, std::filesystem::file_time_type>> deps;
+    ShaderSrc src;
+  };
+  std::unordered_map<std::string, Parsed_> parsed_{};
+
+  const File_* read_file_(const std::filesystem::path& path);
+
+  bool cache_{false};
+  std::filesystem::path cache_dir_{};
+  std::string driver_{}; // vendor, renderer and version
+  double saved_msec_{0.0};
+
+  struct CacheEntry_ {
+    ShaderBinary binary;
+    double compile_msec;
+  };
+
+  std::filesystem::path cache_path_(const ShaderSrc& src) const;
+  std::optional<CacheEntry_> read_cache_(const std::filesystem::path& path) const;
+  void write_cache_(const std::filesystem::path& path, const ShaderBinary& binary, double compile_msec) const;
 };
 } // namespace imp
 
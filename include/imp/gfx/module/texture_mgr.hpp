@@ -2,22 +2,30 @@
 #define IMP_GFX_MODULE_TEXTURE_MGR_HPP
 
 #include "imp/core/module_mgr.hpp"
+#include "imp/gfx/gl/tex_array.hpp"
 #include "imp/gfx/gl/tex_image.hpp"
 #include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace imp {
 
 class Texture {
 public:
   Texture(const std::string& name, TexImage& ti);
+  Texture(const std::string& name, std::shared_ptr<TexArray> arr, GLsizei layer, bool fully_opaque);
 
   std::string name() const;
 
+  TexTarget target() const;
   GLuint id() const;
 
+  // Layer within the owning texture array, always 0 for plain 2D textures
+  GLsizei layer() const;
+
   int w() const;
   int h() const;
 
@@ -27,7 +35,12 @@ public:
 
 private:
   std::string name_;
-  TexImage ti_;
+
+  std::optional<TexImage> ti_{};
+
+  std::shared_ptr<TexArray> arr_{nullptr};
+  GLsizei layer_{0};
+  bool arr_fully_opaque_{true};
 };
 
 class TextureMgr : public Module<TextureMgr> {
@@ -39,8 +52,18 @@ public:
   std::shared_ptr<Texture> load(const std::string& name, const std::filesystem::path& path, bool retro = false);
   std::shared_ptr<Texture> load(const std::filesystem::path& path, bool retro = false);
 
+  // Pack the texture into a GL_TEXTURE_2D_ARRAY shared with every other layered
+  // texture of the same size, so they can all be drawn in one batch
+  std::shared_ptr<Texture> load_layered(const std::string& name, const std::filesystem::path& path, bool retro = false);
+  std::shared_ptr<Texture> load_layered(const std::filesystem::path& path, bool retro = false);
+
 private:
   std::unordered_map<std::string, std::shared_ptr<Texture>> textures_{};
+
+  std::vector<std::shared_ptr<TexArray>> tex_arrays_{};
+  GLint max_array_layers_{0};
+
+  std::shared_ptr<TexArray> get_tex_array_(GLsizei w, GLsizei h, bool retro);
 };
 
 } // namespace imp
@@ -0,0 +1,32 @@
+#ifndef IMP_GFX_VERTEX_TRANSFORM_HPP
+#define IMP_GFX_VERTEX_TRANSFORM_HPP
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace imp {
+// Rotate each point about its own center, with the sine and cosine of its angle given
+//   x' = c * (x - cx) - s * (y - cy) + cx
+//   y' = s * (x - cx) + c * (y - cy) + cy
+// Uses AVX2, SSE2 or NEON when the build targets them, the tail (or everything, without any of
+// them) goes through a scalar loop
+void rotate_points(
+  std::span<float> x, std::span<float> y,
+  std::span<const float> cx, std::span<const float> cy,
+  std::span<const float> c, std::span<const float> s
+);
+
+// Bakes the rotation stored in the last 3 floats of each vertex (center x, center y, angle in
+// radians) into its position, and drops those floats. Holds on to its scratch space between calls
+class VertexFlattener {
+public:
+  // out is overwritten with (floats_per_vertex - 3) floats per vertex
+  void flatten(std::span<const float> in, std::size_t floats_per_vertex, std::vector<float>& out);
+
+private:
+  std::vector<float> x_{}, y_{}, cx_{}, cy_{}, c_{}, s_{};
+};
+} // namespace imp
+
+#endif//IMP_GFX_VERTEX_TRANSFORM_HPP
@@ -9,7 +9,11 @@
 #include "imp/core/prio_list.hpp"
 #include "imp/core/type_id.hpp"
 
+#include "imp/gfx/gl/render_target_pool.hpp"
 #include "imp/gfx/module/2d/gfx_2d.hpp"
+#include "imp/gfx/module/2d/layer_mgr.hpp"
+#include "imp/gfx/module/2d/particle_system.hpp"
+#include "imp/gfx/module/2d/tile_map_mgr.hpp"
 #include "imp/gfx/color.hpp"
 
 #include "imp/util/averagers.hpp"
@@ -2,6 +2,7 @@
 #define IMP_UTIL_AVERAGERS_HPP
 
 #include <cstddef>
+#include <deque>
 #include <queue>
 
 namespace imp {
@@ -49,6 +50,25 @@ private:
   std::queue<double> samples_{};
 };
 
+// Not an average, the largest of the last sample_count values
+class WindowMax : public internal::Averager {
+public:
+  std::size_t sample_count{0};
+
+  WindowMax(std::size_t sample_count);
+
+  void update(double v);
+
+  // Whether a whole window's worth of values has been seen yet
+  bool full() const;
+
+private:
+  std::size_t seen_{0};
+
+  // Candidates for the max, oldest first and strictly decreasing
+  std::deque<std::pair<std::size_t, double>> window_{};
+};
+
 } // namespace imp
 
 #endif//IMP_UTIL_AVERAGERS_HPP
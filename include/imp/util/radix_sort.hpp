@@ -0,0 +1,65 @@
+#ifndef IMP_UTIL_RADIX_SORT_HPP
+#define IMP_UTIL_RADIX_SORT_HPP
+
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace imp {
+/**
+ * Stable LSD radix sort on a 64-bit key, 8 bits per pass
+ * All histograms are built in a single pass over the data, and any pass
+ * where every element shares the same digit is skipped entirely
+ *
+ * @param v the elements to sort, sorted in place
+ * @param scratch storage reused between calls to avoid reallocating
+ * @param key function returning the std::uint64_t key of an element
+ */
+template<typename T, typename KeyFunc>
+  requires std::convertible_to<std::invoke_result_t<KeyFunc, const T&>, std::uint64_t>
+void radix_sort(std::vector<T>& v, std::vector<T>& scratch, KeyFunc&& key) {
+  constexpr std::size_t PASSES = sizeof(std::uint64_t);
+
+  if (v.size() < 2)
+    return;
+
+  std::array<std::array<std::size_t, 256>, PASSES> counts{};
+  for (const auto& e: v) {
+    const std::uint64_t k = key(e);
+    for (std::size_t p = 0; p < PASSES; ++p)
+      counts[p][(k >> (p * 8)) & 0xff]++;
+  }
+
+  scratch.resize(v.size());
+  auto* src = &v;
+  auto* dst = &scratch;
+
+  for (std::size_t p = 0; p < PASSES; ++p) {
+    auto& c = counts[p];
+
+    const std::uint64_t first_digit = (key((*src)[0]) >> (p * 8)) & 0xff;
+    if (c[first_digit] == v.size())
+      continue;
+
+    std::size_t offset = 0;
+    for (auto& n: c) {
+      const auto tmp = n;
+      n = offset;
+      offset += tmp;
+    }
+
+    for (auto& e: *src)
+      (*dst)[c[(key(e) >> (p * 8)) & 0xff]++] = std::move(e);
+
+    std::swap(src, dst);
+  }
+
+  if (src != &v)
+    v.swap(scratch);
+}
+} // namespace imp
+
+#endif//IMP_UTIL_RADIX_SORT_HPP
@@ -2,7 +2,9 @@
 #define IMP_UTIL_SOPS_HPP
 
 #include "re2/re2.h"
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace imp {
@@ -15,6 +17,12 @@ std::string ltrim_copy(std::string s);
 std::string rtrim_copy(std::string s);
 std::string trim_copy(std::string s);
 
+std::string_view rtrim_view(std::string_view s);
+
+// 64-bit FNV-1a, the same on every run and platform (unlike std::hash), so it can name files
+// Pass a previous result as h to hash several strings as one
+std::uint64_t fnv1a(std::string_view s, std::uint64_t h = 0xcbf29ce484222325ull);
+
 std::vector<std::string> split(const std::string& s, char delim);
 std::vector<std::string> split(const std::string& s, const std::string& delim);
 
@@ -1,7 +1,7 @@
 #include "imp/gfx/gl/buffer.hpp"
 
 namespace imp {
-Buffer::Buffer(GfxContext& gfx) : gl(gfx.gl) {
+Buffer::Buffer(GfxContext& gfx) : ctx(gfx), gl(gfx.gl) {
   gen_id_();
 }
 
@@ -9,7 +9,7 @@ Buffer::~Buffer() {
   del_id_();
 }
 
-Buffer::Buffer(Buffer&& other) noexcept : gl(other.gl), id(other.id) {
+Buffer::Buffer(Buffer&& other) noexcept : ctx(other.ctx), gl(other.gl), id(other.id) {
   other.id = 0;
 }
 
@@ -26,11 +26,11 @@ Buffer& Buffer::operator=(Buffer&& other) noexcept {
 }
 
 void Buffer::bind(const BufTarget& target) const {
-  gl.BindBuffer(unwrap(target), id);
+  ctx.bind_buffer(unwrap(target), id);
 }
 
 void Buffer::unbind(const BufTarget& target) const {
-  gl.BindBuffer(unwrap(target), 0);
+  ctx.bind_buffer(unwrap(target), 0);
 }
 
 void Buffer::gen_id_() {
@@ -40,6 +40,7 @@ void Buffer::gen_id_() {
 
 void Buffer::del_id_() {
   if (id != 0) {
+    ctx.forget_buffer(id);
     gl.DeleteBuffers(1, &id);
     IMP_LOG_DEBUG("DEL_ID({}): Buffer", id);
     id = 0;
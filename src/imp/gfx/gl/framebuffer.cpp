@@ -0,0 +1,168 @@
+#include "imp/gfx/gl/framebuffer.hpp"
+
+#include <algorithm>
+
+namespace imp {
+Framebuffer::Framebuffer(GfxContext& gfx, GLsizei w, GLsizei h) : ctx(gfx), gl(gfx.gl), w(w), h(h) {
+  gen_id_();
+}
+
+Framebuffer::~Framebuffer() {
+  del_id_();
+}
+
+Framebuffer::Framebuffer(Framebuffer&& other) noexcept
+  : ctx(other.ctx), gl(other.gl), id(other.id), w(other.w), h(other.h),
+    colors_(std::move(other.colors_)), depth_stencil_(std::move(other.depth_stencil_)) {
+  other.id = 0;
+  other.w = 0;
+  other.h = 0;
+  other.depth_stencil_.reset();
+}
+
+Framebuffer& Framebuffer::operator=(Framebuffer&& other) noexcept {
+  if (this != &other) {
+    del_id_();
+
+    gl = other.gl;
+    id = other.id;
+    w = other.w;
+    h = other.h;
+    colors_ = std::move(other.colors_);
+    depth_stencil_ = std::move(other.depth_stencil_);
+
+    other.id = 0;
+    other.w = 0;
+    other.h = 0;
+    other.depth_stencil_.reset();
+  }
+  return *this;
+}
+
+void Framebuffer::bind() {
+  ctx.bind_framebuffer(GL_FRAMEBUFFER, id);
+}
+
+void Framebuffer::unbind() {
+  ctx.bind_framebuffer(GL_FRAMEBUFFER, 0);
+}
+
+TexImage& Framebuffer::attach_color(TexFormat format, GLuint index, bool retro) {
+  std::erase_if(colors_, [&](const auto& a) { return a.index == index; });
+
+  auto& a = colors_.emplace_back(index, format, retro, TexImage(ctx, format, w, h, retro));
+  attach_color_(a);
+  update_draw_buffers_();
+  return a.tex;
+}
+
+Renderbuffer& Framebuffer::attach_depth_stencil(RBufFormat format) {
+  depth_stencil_.emplace(format, Renderbuffer(ctx, format, w, h));
+  attach_depth_stencil_(*depth_stencil_);
+  return depth_stencil_->rbo;
+}
+
+TexImage* Framebuffer::color(GLuint index) {
+  auto it = std::ranges::find(colors_, index, &ColorAttachment_::index);
+  return it != colors_.end() ? &it->tex : nullptr;
+}
+
+Renderbuffer* Framebuffer::depth_stencil() {
+  return depth_stencil_ ? &depth_stencil_->rbo : nullptr;
+}
+
+void Framebuffer::resize(GLsizei w, GLsizei h) {
+  if (this->w == w && this->h == h)
+    return;
+
+  this->w = w;
+  this->h = h;
+
+  for (auto& a: colors_) {
+    a.tex = TexImage(ctx, a.format, w, h, a.retro);
+    attach_color_(a);
+  }
+
+  if (depth_stencil_) {
+    depth_stencil_->rbo = Renderbuffer(ctx, depth_stencil_->format, w, h);
+    attach_depth_stencil_(*depth_stencil_);
+  }
+}
+
+bool Framebuffer::is_complete() {
+  GLenum status;
+  {
+    EditScope_ scope(*this);
+    status = gl.CheckFramebufferStatus(GL_FRAMEBUFFER);
+  }
+
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    IMP_LOG_ERROR("Framebuffer {} is incomplete: 0x{:x}", id, status);
+    return false;
+  }
+  return true;
+}
+
+void Framebuffer::attach_color_(const ColorAttachment_& a) {
+  EditScope_ scope(*this);
+  gl.FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + a.index, GL_TEXTURE_2D, a.tex.id, 0);
+}
+
+void Framebuffer::attach_depth_stencil_(const DepthStencilAttachment_& a) {
+  GLenum attachment;
+  switch (a.format) {
+    case RBufFormat::d24_s8:
+    case RBufFormat::d32f_s8:
+      attachment = GL_DEPTH_STENCIL_ATTACHMENT;
+      break;
+    case RBufFormat::s8:
+      attachment = GL_STENCIL_ATTACHMENT;
+      break;
+    default:
+      attachment = GL_DEPTH_ATTACHMENT;
+      break;
+  }
+
+  EditScope_ scope(*this);
+  gl.FramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, a.rbo.id);
+}
+
+void Framebuffer::update_draw_buffers_() {
+  GLuint count = 0;
+  for (const auto& a: colors_)
+    count = std::max(count, a.index + 1);
+
+  // Gaps are left as GL_NONE so fragment outputs keep their locations
+  std::vector<GLenum> bufs(count, GL_NONE);
+  for (const auto& a: colors_)
+    bufs[a.index] = GL_COLOR_ATTACHMENT0 + a.index;
+
+  EditScope_ scope(*this);
+  gl.DrawBuffers(static_cast<GLsizei>(bufs.size()), bufs.data());
+}
+
+Framebuffer::EditScope_::EditScope_(Framebuffer& fbo)
+  : ctx_(fbo.ctx), prev_draw_(fbo.ctx.framebuffer(GL_DRAW_FRAMEBUFFER)),
+    prev_read_(fbo.ctx.framebuffer(GL_READ_FRAMEBUFFER)) {
+  fbo.bind();
+}
+
+Framebuffer::EditScope_::~EditScope_() {
+  ctx_.bind_framebuffer(GL_DRAW_FRAMEBUFFER, prev_draw_);
+  ctx_.bind_framebuffer(GL_READ_FRAMEBUFFER, prev_read_);
+}
+
+void Framebuffer::gen_id_() {
+  gl.GenFramebuffers(1, &id);
+  IMP_LOG_DEBUG("GEN_ID({}): Framebuffer", id);
+}
+
+void Framebuffer::del_id_() {
+  if (id != 0) {
+    ctx.forget_framebuffer(id);
+    gl.DeleteFramebuffers(1, &id);
+    IMP_LOG_DEBUG("DEL_ID({}): Framebuffer", id);
+    id = 0;
+  }
+}
+} // namespace imp
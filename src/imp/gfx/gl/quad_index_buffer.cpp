@@ -0,0 +1,47 @@
+#include "imp/gfx/gl/quad_index_buffer.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace imp {
+QuadIndexBuffer::QuadIndexBuffer(GfxContext& gfx) : Buffer(gfx) {}
+
+void QuadIndexBuffer::reserve(std::size_t quads) {
+  if (quads <= quads_)
+    return;
+
+  const auto new_quads = std::max({quads, quads_ * 2, std::size_t{1024}});
+
+  std::vector<unsigned int> indices(new_quads * 6);
+  for (std::size_t q = 0; q < new_quads; ++q) {
+    const auto v = static_cast<unsigned int>(q * 4);
+    auto* out = &indices[q * 6];
+    out[0] = v;
+    out[1] = v + 1;
+    out[2] = v + 2;
+    out[3] = v;
+    out[4] = v + 2;
+    out[5] = v + 3;
+  }
+
+  // The element array binding belongs to whatever VAO is bound, so make sure none is
+  ctx.bind_vertex_array(0);
+  bind(BufTarget::element_array);
+  gl.BufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * indices.size(), indices.data(), GL_STATIC_DRAW);
+  unbind(BufTarget::element_array);
+
+  IMP_LOG_DEBUG("Quad index buffer grown to {} quads", new_quads);
+  quads_ = new_quads;
+}
+
+std::size_t QuadIndexBuffer::capacity() const {
+  return quads_;
+}
+
+bool is_quad(std::span<const float> data, std::span<const unsigned int> indices, std::size_t floats_per_vertex,
+             bool insert_restart) {
+  return !insert_restart && data.size() == 4 * floats_per_vertex && indices.size() == 6 &&
+         indices[0] == 0 && indices[1] == 1 && indices[2] == 2 &&
+         indices[3] == 0 && indices[4] == 2 && indices[5] == 3;
+}
+} // namespace imp
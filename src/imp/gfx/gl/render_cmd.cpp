@@ -0,0 +1,354 @@
+#include "imp/gfx/gl/render_cmd.hpp"
+
+#include "glm/gtc/type_ptr.hpp"
+#include <algorithm>
+
+namespace imp {
+void RenderCmdBuffer::bind_program(GLuint id) {
+  cmds_.emplace_back(RenderCmd{.type = RenderCmdType::bind_program, .id = id});
+}
+
+void RenderCmdBuffer::bind_vao(GLuint id) {
+  cmds_.emplace_back(RenderCmd{.type = RenderCmdType::bind_vao, .id = id});
+}
+
+void RenderCmdBuffer::bind_texture(GLenum target, GLuint id) {
+  cmds_.emplace_back(RenderCmd{.type = RenderCmdType::bind_texture, .target = target, .id = id});
+}
+
+void RenderCmdBuffer::set_transform(GLint loc_model) {
+  cmds_.emplace_back(RenderCmd{.type = RenderCmdType::set_transform, .loc_model = loc_model});
+}
+
+void RenderCmdBuffer::set_transform(GLint loc_model, const glm::mat4& transform, float z_offset) {
+  // Repeated transforms share an index, so the uniforms can be recognized as unchanged
+  if (transforms_.empty() || transforms_.back() != transform)
+    transforms_.emplace_back(transform);
+  cmds_.emplace_back(RenderCmd{
+    .type = RenderCmdType::set_transform,
+    .id = static_cast<GLuint>(transforms_.size()),
+    .loc_model = loc_model,
+    .z_offset = z_offset
+  });
+}
+
+void RenderCmdBuffer::draw_elements(DrawMode mode, GLsizei count, GLsizei first, GLint base_vertex) {
+  if (count <= 0)
+    return;
+  cmds_.emplace_back(RenderCmd{
+    .type = RenderCmdType::draw_elements,
+    .target = unwrap(mode),
+    .count = count,
+    .first = first,
+    .base_vertex = base_vertex
+  });
+}
+
+void RenderCmdBuffer::draw_arrays(DrawMode mode, GLsizei count, GLsizei first) {
+  if (count <= 0)
+    return;
+  cmds_.emplace_back(RenderCmd{.type = RenderCmdType::draw_arrays, .target = unwrap(mode), .count = count, .first = first});
+}
+
+void RenderCmdBuffer::append(const RenderCmdBuffer& other) {
+  const auto transform_base = static_cast<GLuint>(transforms_.size());
+  const auto range_base = static_cast<GLsizei>(ranges_.size());
+  for (auto c: other.cmds_) {
+    if (c.type == RenderCmdType::set_transform && c.id != 0)
+      c.id += transform_base;
+    else if (c.type == RenderCmdType::multi_draw_elements)
+      c.first += range_base;
+    cmds_.emplace_back(c);
+  }
+  transforms_.insert(transforms_.end(), other.transforms_.begin(), other.transforms_.end());
+  ranges_.insert(ranges_.end(), other.ranges_.begin(), other.ranges_.end());
+}
+
+void RenderCmdBuffer::coalesce() {
+  std::vector<RenderCmd> out{};
+  out.reserve(cmds_.size());
+
+  GLuint program = 0, vao = 0;
+  GLenum tex_target = 0;
+  GLuint tex_id = 0;
+  bool tex_known = false;
+
+  struct UniformState_ {
+    GLuint program;
+    GLuint transform;
+    float z_offset;
+  };
+  std::vector<UniformState_> uniforms_set{};
+
+  // Draws since the last state change, all with the same mode
+  GLenum run_mode = 0;
+  std::vector<DrawElementsIndirectCmd> run{};
+
+  const auto flush = [&] {
+    if (run.empty())
+      return;
+
+    if (run.size() == 1) {
+      out.emplace_back(RenderCmd{
+        .type = RenderCmdType::draw_elements,
+        .target = run_mode,
+        .count = static_cast<GLsizei>(run[0].count),
+        .first = static_cast<GLsizei>(run[0].first_index),
+        .base_vertex = run[0].base_vertex
+      });
+    } else {
+      out.emplace_back(RenderCmd{
+        .type = RenderCmdType::multi_draw_elements,
+        .target = run_mode,
+        .count = static_cast<GLsizei>(run.size()),
+        .first = static_cast<GLsizei>(ranges_.size())
+      });
+      ranges_.insert(ranges_.end(), run.begin(), run.end());
+    }
+    run.clear();
+  };
+
+  const auto state_change = [&](const RenderCmd& c) {
+    flush();
+    out.emplace_back(c);
+  };
+
+  // Commands from an earlier coalesce() keep their ranges, so start the new ones after them
+  const auto old_ranges = std::move(ranges_);
+  ranges_.clear();
+
+  for (const auto& c: cmds_) {
+    switch (c.type) {
+      case RenderCmdType::bind_program:
+        if (c.id != program) {
+          state_change(c);
+          program = c.id;
+        }
+        break;
+
+      case RenderCmdType::bind_vao:
+        if (c.id != vao) {
+          state_change(c);
+          vao = c.id;
+        }
+        break;
+
+      case RenderCmdType::bind_texture:
+        if (!tex_known || c.target != tex_target || c.id != tex_id) {
+          state_change(c);
+          tex_target = c.target;
+          tex_id = c.id;
+          tex_known = true;
+        }
+        break;
+
+      case RenderCmdType::set_transform: {
+        // A program that hasn't been given a transform yet has the identity
+        auto it = std::ranges::find(uniforms_set, program, &UniformState_::program);
+        const auto transform = it != uniforms_set.end() ? it->transform : 0u;
+        const auto z_offset = it != uniforms_set.end() ? it->z_offset : 0.0f;
+        if (transform == c.id && z_offset == c.z_offset)
+          break;
+
+        state_change(c);
+        if (it != uniforms_set.end())
+          *it = {program, c.id, c.z_offset};
+        else
+          uniforms_set.emplace_back(program, c.id, c.z_offset);
+        break;
+      }
+
+      case RenderCmdType::draw_elements:
+        if (!run.empty() && run_mode != c.target)
+          flush();
+        run_mode = c.target;
+
+        if (!run.empty() && run.back().base_vertex == c.base_vertex &&
+            run.back().first_index + run.back().count == static_cast<GLuint>(c.first))
+          run.back().count += static_cast<GLuint>(c.count);
+        else
+          run.emplace_back(static_cast<GLuint>(c.count), 1u, static_cast<GLuint>(c.first), c.base_vertex, 0u);
+        break;
+
+      case RenderCmdType::multi_draw_elements:
+        if (!run.empty() && run_mode != c.target)
+          flush();
+        run_mode = c.target;
+
+        for (GLsizei i = 0; i < c.count; ++i)
+          run.emplace_back(old_ranges[c.first + i]);
+        break;
+
+      case RenderCmdType::draw_arrays:
+        flush();
+        if (!out.empty() && out.back().type == RenderCmdType::draw_arrays && out.back().target == c.target &&
+            out.back().first + out.back().count == c.first)
+          out.back().count += c.count;
+        else
+          out.emplace_back(c);
+        break;
+    }
+  }
+  flush();
+
+  cmds_ = std::move(out);
+}
+
+std::span<const RenderCmd> RenderCmdBuffer::commands() const {
+  return cmds_;
+}
+
+std::span<const DrawElementsIndirectCmd> RenderCmdBuffer::ranges() const {
+  return ranges_;
+}
+
+std::size_t RenderCmdBuffer::size() const {
+  return cmds_.size();
+}
+
+bool RenderCmdBuffer::empty() const {
+  return cmds_.empty();
+}
+
+void RenderCmdBuffer::clear() {
+  cmds_.clear();
+  transforms_.clear();
+  ranges_.clear();
+}
+
+RenderCmdStats RenderCmdBuffer::execute(GfxContext& ctx, float z_max, UVBuffer* indirect) const {
+  RenderCmdStats stats{};
+
+  const bool use_indirect = indirect && !ranges_.empty();
+  std::size_t indirect_base = 0;
+  if (use_indirect) {
+    indirect_base = indirect->size() / 5;
+    for (const auto& r: ranges_)
+      indirect->add({r.count, r.instance_count, r.first_index, static_cast<GLuint>(r.base_vertex), r.base_instance});
+    indirect->sync();
+    indirect->bind(BufTarget::draw_indirect);
+  }
+
+  const auto count = [&stats](bool issued) {
+    if (issued)
+      stats.issued++;
+    else
+      stats.elided++;
+  };
+
+  GLuint program = 0;
+
+  // Uniforms live in the program, so each program only needs them again when they change
+  // Every program starts out (and is left) with the identity as its model matrix
+  struct UniformState_ {
+    GLuint program;
+    GLint loc_model;
+    GLuint transform;
+    float z_offset;
+  };
+  std::vector<UniformState_> uniforms_set{};
+
+  for (const auto& c: cmds_) {
+    switch (c.type) {
+      case RenderCmdType::bind_program:
+        count(ctx.use_program(c.id));
+        program = c.id;
+        break;
+
+      case RenderCmdType::bind_vao:
+        count(ctx.bind_vertex_array(c.id));
+        break;
+
+      case RenderCmdType::bind_texture:
+        count(ctx.bind_texture(c.target, c.id));
+        break;
+
+      case RenderCmdType::set_transform: {
+        auto it = std::ranges::find(uniforms_set, program, &UniformState_::program);
+        const auto transform = it != uniforms_set.end() ? it->transform : 0u;
+        const auto z_offset = it != uniforms_set.end() ? it->z_offset : 0.0f;
+        if (transform == c.id && z_offset == c.z_offset) {
+          count(false);
+          break;
+        }
+
+        if (c.loc_model != -1) {
+          // The shaders map z to (z - z_max) / (z_max + 1) before applying the model matrix, so
+          // an offset in z is a translation by offset / (z_max + 1) at that point
+          glm::mat4 z_shift(1.0f);
+          z_shift[3][2] = c.z_offset / (z_max + 1.0f);
+          const glm::mat4 m = c.id == 0 ? z_shift : transforms_[c.id - 1] * z_shift;
+          ctx.gl.UniformMatrix4fv(c.loc_model, 1, GL_FALSE, glm::value_ptr(m));
+        }
+
+        if (it != uniforms_set.end())
+          *it = {program, c.loc_model, c.id, c.z_offset};
+        else
+          uniforms_set.emplace_back(program, c.loc_model, c.id, c.z_offset);
+        count(true);
+        break;
+      }
+
+      case RenderCmdType::draw_elements:
+        ctx.gl.DrawElementsBaseVertex(
+          c.target,
+          c.count,
+          GL_UNSIGNED_INT,
+          reinterpret_cast<void*>(static_cast<std::size_t>(c.first) * sizeof(unsigned int)),
+          c.base_vertex
+        );
+        stats.draws++;
+        stats.ranges++;
+        break;
+
+      case RenderCmdType::multi_draw_elements:
+        if (use_indirect) {
+          ctx.gl.MultiDrawElementsIndirect(
+            c.target,
+            GL_UNSIGNED_INT,
+            reinterpret_cast<void*>((indirect_base + c.first) * sizeof(DrawElementsIndirectCmd)),
+            c.count,
+            0
+          );
+          stats.draws++;
+        } else {
+          for (GLsizei i = 0; i < c.count; ++i) {
+            const auto& r = ranges_[c.first + i];
+            ctx.gl.DrawElementsBaseVertex(
+              c.target,
+              static_cast<GLsizei>(r.count),
+              GL_UNSIGNED_INT,
+              reinterpret_cast<void*>(static_cast<std::size_t>(r.first_index) * sizeof(unsigned int)),
+              r.base_vertex
+            );
+            stats.draws++;
+          }
+        }
+        stats.ranges += c.count;
+        break;
+
+      case RenderCmdType::draw_arrays:
+        ctx.gl.DrawArrays(c.target, c.first, c.count);
+        stats.draws++;
+        stats.ranges++;
+        break;
+    }
+  }
+
+  // Put back the identity anywhere a transform was left behind
+  const glm::mat4 identity(1.0f);
+  for (const auto& u: uniforms_set) {
+    if (u.loc_model == -1 || (u.transform == 0 && u.z_offset == 0.0f))
+      continue;
+    ctx.use_program(u.program);
+    ctx.gl.UniformMatrix4fv(u.loc_model, 1, GL_FALSE, glm::value_ptr(identity));
+    stats.issued++;
+  }
+
+  if (use_indirect)
+    indirect->unbind(BufTarget::draw_indirect);
+  ctx.bind_vertex_array(0);
+
+  return stats;
+}
+} // namespace imp
@@ -0,0 +1,85 @@
+#include "imp/gfx/gl/render_target_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace imp {
+RenderTargetPool::RenderTargetPool(GfxContext& gfx) : ctx_(gfx) {
+  glfwGetFramebufferSize(ctx_.window->handle(), &screen_size_.x, &screen_size_.y);
+}
+
+Framebuffer& RenderTargetPool::acquire(glm::ivec2 size, TexFormat color, std::optional<RBufFormat> depth_stencil) {
+  return acquire_(size, color, depth_stencil, std::nullopt);
+}
+
+Framebuffer& RenderTargetPool::acquire_screen(float scale, TexFormat color, std::optional<RBufFormat> depth_stencil) {
+  return acquire_(scaled_(screen_size_, scale), color, depth_stencil, scale);
+}
+
+void RenderTargetPool::clear() {
+  std::erase_if(entries_, [](const Entry_& e) { return !e.in_use; });
+}
+
+const RenderTargetStats& RenderTargetPool::stats() const {
+  return last_stats_;
+}
+
+Framebuffer& RenderTargetPool::acquire_(glm::ivec2 size, TexFormat color, std::optional<RBufFormat> depth_stencil,
+                                        std::optional<float> screen_scale) {
+  auto it = std::ranges::find_if(entries_, [&](const Entry_& e) {
+    return !e.in_use && e.color == color && e.depth_stencil == depth_stencil && e.screen_scale == screen_scale &&
+           e.fbo->w == size.x && e.fbo->h == size.y;
+  });
+
+  if (it == entries_.end()) {
+    auto fbo = std::make_unique<Framebuffer>(ctx_, size.x, size.y);
+    fbo->attach_color(color);
+    if (depth_stencil)
+      fbo->attach_depth_stencil(*depth_stencil);
+    fbo->is_complete();
+
+    entries_.emplace_back(std::move(fbo), color, depth_stencil, screen_scale, false, frame_);
+    it = std::prev(entries_.end());
+    frame_allocated_++;
+  }
+
+  it->in_use = true;
+  it->last_used = frame_;
+  return *it->fbo;
+}
+
+glm::ivec2 RenderTargetPool::scaled_(glm::ivec2 size, float scale) {
+  return {
+    std::max(1, static_cast<int>(std::lround(size.x * scale))),
+    std::max(1, static_cast<int>(std::lround(size.y * scale)))
+  };
+}
+
+void RenderTargetPool::end_frame_() {
+  last_stats_.pooled = entries_.size();
+  last_stats_.in_use = std::ranges::count_if(entries_, &Entry_::in_use);
+  last_stats_.allocated = frame_allocated_;
+  frame_allocated_ = 0;
+
+  for (auto& e: entries_)
+    e.in_use = false;
+  std::erase_if(entries_, [&](const Entry_& e) { return frame_ - e.last_used > RENDER_TARGET_EVICT_FRAMES; });
+
+  frame_++;
+}
+
+void RenderTargetPool::resize_screen_(glm::ivec2 size) {
+  // Minimizing reports a zero size, keep the old targets around for when the window comes back
+  if (size.x <= 0 || size.y <= 0)
+    return;
+
+  screen_size_ = size;
+  for (auto& e: entries_) {
+    if (!e.screen_scale)
+      continue;
+
+    const auto scaled = scaled_(size, *e.screen_scale);
+    e.fbo->resize(scaled.x, scaled.y);
+  }
+}
+} // namespace imp
@@ -3,72 +3,119 @@
 #include "imp/util/rnd.hpp"
 #include "imp/util/sops.hpp"
 #include "glm/gtc/type_ptr.hpp"
+#include <algorithm>
 #include <fstream>
 #include <utility>
 
 namespace imp {
-std::optional<std::string> read_file_process_includes(
-  const std::filesystem::path& path,
-  std::vector<std::filesystem::path>& included_paths
-) {
-  const static RE2 spaces_pat{R"((\s+))"};
-  assert(spaces_pat.ok());
+namespace {
+// The path out of a line of the form
+//   #include "<path>"
+std::optional<std::string_view> scan_include(std::string_view line) {
+  line.remove_prefix(std::string_view("#include").size());
+  const auto open = line.find_first_not_of(" \t");
+  if (open == std::string_view::npos || line[open] != '"')
+    return std::nullopt;
 
-  const static RE2 path_pat{R"("(.+)\")"};
-  assert(path_pat.ok());
+  const auto close = line.find('"', open + 1);
+  if (close == std::string_view::npos || close == open + 1)
+    return std::nullopt;
 
-  included_paths.emplace_back(path);
+  return line.substr(open + 1, close - open - 1);
+}
 
-  std::ifstream ifs(path.string());
-  if (!ifs.is_open()) {
-    IMP_LOG_ERROR("Failed to open file: '{}'", path.string());
+struct Pragma {
+  std::string_view name;
+  std::string_view args;  // empty without parens
+  std::string_view extra; // anything after the closing paren
+  bool has_args;
+};
+
+// Lines of the form
+//   #pragma <name>(<args>)<extra>
+//   #pragma <name>
+// Parens anywhere in a pragma without args make it not a pragma at all
+std::optional<Pragma> scan_pragma(std::string_view line) {
+  constexpr std::string_view prefix = "#pragma ";
+  if (!line.starts_with(prefix))
     return std::nullopt;
-  }
+  line.remove_prefix(prefix.size());
 
-  std::string s;
-  std::size_t line_no = 1;
-  for (std::string line; std::getline(ifs, line); ++line_no) {
-    rtrim(line);
+  const auto open = line.find('(');
+  if (open == std::string_view::npos) {
+    if (line.empty() || line.find(')') != std::string_view::npos)
+      return std::nullopt;
+    return Pragma{line, {}, {}, false};
+  }
 
-    if (line.starts_with("#include")) {
-      auto tokens = split_re(line, spaces_pat);
+  const auto close = line.rfind(')');
+  if (open == 0 || close == std::string_view::npos || close <= open + 1)
+    return std::nullopt;
+  return Pragma{line.substr(0, open), line.substr(open + 1, close - open - 1), line.substr(close + 1), true};
+}
 
-      std::string include;
-      if (tokens.size() < 2 || !RE2::FullMatch(tokens[1], path_pat, &include)) {
-        IMP_LOG_ERROR("Failed to parse include in file {}:{}: '{}'", path.string(), line_no, line);
-        return std::nullopt;
-      }
+// Calls f(line, line_no) for every line, with trailing whitespace trimmed
+template<typename F>
+bool for_each_line(std::string_view text, F&& f) {
+  for (std::size_t line_no = 1; !text.empty(); ++line_no) {
+    const auto nl = text.find('\n');
+    const auto line = rtrim_view(text.substr(0, nl));
+    text = nl == std::string_view::npos ? std::string_view{} : text.substr(nl + 1);
+    if (!f(line, line_no))
+      return false;
+  }
+  return true;
+}
 
-      auto include_path = path.parent_path() / include;
-      if (std::ranges::find(included_paths, include_path) != included_paths.end())
-        continue; // Don't try and include a file twice
+std::optional<std::string> read_file(const std::filesystem::path& path) {
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs.is_open())
+    return std::nullopt;
+  return std::string{std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()};
+}
 
-      auto include_file = read_file_process_includes(include_path, included_paths);
-      if (!include_file)
-        return std::nullopt;
+bool process_includes(
+  const std::filesystem::path& path,
+  const ShaderSrc::FileReader& read,
+  std::vector<std::filesystem::path>& included_paths,
+  std::string& out
+) {
+  included_paths.emplace_back(path);
 
-      s += *include_file + '\n';
-    } else
-      s += line + '\n';
+  const auto text = read(path);
+  if (!text) {
+    IMP_LOG_ERROR("Failed to open file: '{}'", path.string());
+    return false;
   }
+  out.reserve(out.size() + text->size());
 
-  return s;
-}
+  return for_each_line(*text, [&](std::string_view line, std::size_t line_no) {
+    if (!line.starts_with("#include")) {
+      out.append(line);
+      out += '\n';
+      return true;
+    }
 
-std::optional<ShaderSrc> try_parse_shader_src(const std::string& src) {
-  enum class BufferDst { vertex, fragment };
+    const auto include = scan_include(line);
+    if (!include) {
+      IMP_LOG_ERROR("Failed to parse include in file {}:{}: '{}'", path.string(), line_no, line);
+      return false;
+    }
 
-  // Match things of the form
-  //   #pragma <name>(<args>)<bad>\n
-  // Captures what is after the parens to emit warnings
-  const static RE2 pragma_w_args(R"(#pragma (.+)\((.+)\)(.*))");
-  assert(pragma_w_args.ok());
+    const auto include_path = path.parent_path() / *include;
+    if (std::ranges::find(included_paths, include_path) != included_paths.end())
+      return true; // Don't try and include a file twice
 
-  // Match things of the form
-  //   #pragma <name>\n
-  // Should reject parens
-  const static RE2 pragma_no_args(R"(#pragma ([^()\n]+))");
-  assert(pragma_no_args.ok());
+    if (!process_includes(include_path, read, included_paths, out))
+      return false;
+    out += '\n';
+    return true;
+  });
+}
+} // namespace
+
+std::optional<ShaderSrc> try_parse_shader_src(const std::string& src) {
+  enum class BufferDst { vertex, fragment, compute };
 
   ShaderSrc s{};
   // Intermediate storage control
@@ -96,53 +143,58 @@ std::optional<ShaderSrc> try_parse_shader_src(const std::string& src) {
         if (!s.fragment)
           s.fragment = buffer;
         break;
+
+      case compute:
+        if (!s.compute)
+          s.compute = buffer;
+        break;
     }
 
     buffer.clear();
   };
 
-  // Variables to store regex match captures
-  std::string pragma_name;
-  std::string pragma_args;
-  std::string pragma_extra;
-
-  std::istringstream iss{src};
-  std::size_t line_no = 1;
-  for (std::string line; std::getline(iss, line); ++line_no) {
-    rtrim(line);
-
+  // Pragmas pick which stage the lines after them go into, anything else is shader source
+  for_each_line(src, [&](std::string_view line, std::size_t line_no) {
     if (line.empty()) {
       if (!buffer.empty())
         buffer.append("\n");
-      continue;
+      return true;
     }
 
-    if (RE2::FullMatch(line, pragma_w_args, &pragma_name, &pragma_args, &pragma_extra)) {
-      if (pragma_name == "name")
-        s.name = pragma_args;
+    const auto pragma = scan_pragma(line);
+    if (!pragma) {
+      read_non_pragma_line = true;
+      buffer.append(line);
+      buffer += '\n';
+    } else if (pragma->has_args) {
+      if (pragma->name == "name")
+        s.name = std::string(pragma->args);
       else
         IMP_LOG_WARN("Unrecognized pragma in shader {}:{}: {}", s.name.value_or("undef"), line_no, line);
 
-      if (!pragma_extra.empty())
+      if (!pragma->extra.empty())
         IMP_LOG_WARN("Trailing characters on pragma in shader {}:{}: {}", s.name.value_or("undef"), line_no, line);
-    } else if (RE2::FullMatch(line, pragma_no_args, &pragma_name)) {
-      if (pragma_name == "vertex") {
+    } else {
+      if (pragma->name == "vertex") {
         if (s.vertex)
           IMP_LOG_WARN("Duplicate vertex pragma in shader {}:{}, will ignore", s.name.value_or("undef"), line_no);
         try_set_shader_part();
         buffer_dst = BufferDst::vertex;
-      } else if (pragma_name == "fragment") {
+      } else if (pragma->name == "fragment") {
         if (s.fragment)
           IMP_LOG_WARN("Duplicate fragment pragma in shader {}:{}, will ignore", s.name.value_or("undef"), line_no);
         try_set_shader_part();
         buffer_dst = BufferDst::fragment;
+      } else if (pragma->name == "compute") {
+        if (s.compute)
+          IMP_LOG_WARN("Duplicate compute pragma in shader {}:{}, will ignore", s.name.value_or("undef"), line_no);
+        try_set_shader_part();
+        buffer_dst = BufferDst::compute;
       } else
         IMP_LOG_WARN("Unrecognized pragma in shader {}:{}: {}", s.name.value_or("undef"), line_no, line);
-    } else {
-      read_non_pragma_line = true;
-      buffer.append(line + '\n');
     }
-  }
+    return true;
+  });
 
   if (!buffer.empty())
     try_set_shader_part();
@@ -170,6 +222,12 @@ std::string ShaderSrc::get() const {
     s += fmt::format("{}\n", *fragment);
   }
 
+  if (compute) {
+    s += fmt::format("#pragma compute\n");
+    s += "\n";
+    s += fmt::format("{}\n", *compute);
+  }
+
   return s;
 }
 
@@ -178,31 +236,54 @@ std::optional<ShaderSrc> ShaderSrc::parse(const std::string& src) {
 }
 
 std::optional<ShaderSrc> ShaderSrc::parse(const std::filesystem::path& path) {
+  return parse(path, read_file);
+}
+
+std::optional<ShaderSrc> ShaderSrc::parse(const std::filesystem::path& path, const FileReader& read) {
   std::vector<std::filesystem::path> included_paths{};
-  auto src = read_file_process_includes(path, included_paths);
-  if (!src)
+  std::string src;
+  if (!process_includes(path, read, included_paths, src))
     return std::nullopt;
 
-  return try_parse_shader_src(*src);
+  return try_parse_shader_src(src);
+}
+
+std::uint64_t ShaderSrc::hash() const {
+  return fnv1a(get());
 }
 
 Shader::Shader(GfxContext& gfx, const ShaderSrc& src)
-  : gl(gfx.gl), name(src.name.value_or(rnd::base58(11))) {
+  : ctx(gfx), gl(gfx.gl), name(src.name.value_or(rnd::base58(11))) {
   gen_id_();
   compile_shader_src_(src);
 }
 
+Shader::Shader(GfxContext& gfx, const ShaderSrc& src, const ShaderBinary& binary)
+  : ctx(gfx), gl(gfx.gl), name(src.name.value_or(rnd::base58(11))) {
+  gen_id_();
+  if (!load_binary_(src, binary)) {
+    // A failed glProgramBinary leaves the program in an unknown state, start from a clean one
+    del_id_();
+    gen_id_();
+    compile_shader_src_(src);
+  }
+}
+
 Shader::~Shader() {
   del_id_();
 }
 
 Shader::Shader(Shader&& other) noexcept
-  : gl(other.gl), id(other.id), name(other.name),
-    src_(other.src_),
-    attrib_locs_(std::move(other.attrib_locs_)), uniform_locs_(std::move(other.uniform_locs_)) {
+  : ctx(other.ctx), gl(other.gl), id(other.id), name(other.name),
+    src_(other.src_), linked_(other.linked_), from_binary_(other.from_binary_),
+    attrib_locs_(std::move(other.attrib_locs_)), layout_locs_(std::move(other.layout_locs_)),
+    uniform_locs_(std::move(other.uniform_locs_)),
+    uniform_handles_(std::move(other.uniform_handles_)), uniform_blocks_(std::move(other.uniform_blocks_)) {
   other.id = 0;
   other.name = "";
   other.src_ = ShaderSrc{};
+  other.linked_ = false;
+  other.from_binary_ = false;
 }
 
 Shader& Shader::operator=(Shader&& other) noexcept {
@@ -213,12 +294,19 @@ Shader& Shader::operator=(Shader&& other) noexcept {
     id = other.id;
     name = other.name;
     src_ = other.src_;
+    linked_ = other.linked_;
+    from_binary_ = other.from_binary_;
     attrib_locs_ = std::move(other.attrib_locs_);
+    layout_locs_ = std::move(other.layout_locs_);
     uniform_locs_ = std::move(other.uniform_locs_);
+    uniform_handles_ = std::move(other.uniform_handles_);
+    uniform_blocks_ = std::move(other.uniform_blocks_);
 
     other.id = 0;
     other.name = "";
     other.src_ = ShaderSrc{};
+    other.linked_ = false;
+    other.from_binary_ = false;
   }
   return *this;
 }
@@ -227,6 +315,33 @@ std::string Shader::src() const {
   return src_.get();
 }
 
+std::uint64_t Shader::src_hash() const {
+  return src_.hash();
+}
+
+bool Shader::linked() const {
+  return linked_;
+}
+
+bool Shader::from_binary() const {
+  return from_binary_;
+}
+
+std::optional<ShaderBinary> Shader::binary() const {
+  if (!linked_ || !gl.GetProgramBinary)
+    return std::nullopt;
+
+  GLint length = 0;
+  gl.GetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return std::nullopt;
+
+  ShaderBinary b{};
+  b.data.resize(static_cast<std::size_t>(length));
+  gl.GetProgramBinary(id, length, nullptr, &b.format, b.data.data());
+  return b;
+}
+
 void Shader::recompile(const ShaderSrc& src) {
   auto old_id = id;
 
@@ -235,13 +350,19 @@ void Shader::recompile(const ShaderSrc& src) {
     del_id_(old_id);
 
     attrib_locs_.clear();
+    layout_locs_.clear();
     uniform_locs_.clear();
+
+    for (auto& [uniform_name, loc]: uniform_handles_)
+      loc = gl.GetUniformLocation(id, uniform_name.c_str());
+    for (const auto& [block_name, binding]: uniform_blocks_)
+      bind_uniform_block_(block_name, binding);
   } else
     id = old_id;
 }
 
 void Shader::use() {
-  gl.UseProgram(id);
+  ctx.use_program(id);
 }
 
 GLint Shader::get_attrib_loc(const std::string& attrib_name) {
@@ -257,206 +378,298 @@ GLint Shader::get_attrib_loc(const std::string& attrib_name) {
   return loc;
 }
 
+std::span<const GLint> Shader::attrib_locs(const VertexLayout& layout) {
+  auto it = layout_locs_.find(&layout);
+  if (it != layout_locs_.end())
+    return it->second;
+
+  std::vector<GLint> locs(layout.count);
+  for (std::size_t i = 0; i < layout.count; ++i)
+    locs[i] = get_attrib_loc(layout.attribs[i].name);
+
+  return layout_locs_.emplace(&layout, std::move(locs)).first->second;
+}
+
+bool Shader::uniform_block(const std::string& block_name, GLuint binding) {
+  uniform_blocks_[block_name] = binding;
+  return bind_uniform_block_(block_name, binding);
+}
+
+void Shader::set(Uniform<float> u, float v) {
+  if (u.loc() != -1)
+    gl.Uniform1f(u.loc(), v);
+}
+
+void Shader::set(Uniform<glm::vec2> u, glm::vec2 v) {
+  if (u.loc() != -1)
+    gl.Uniform2fv(u.loc(), 1, glm::value_ptr(v));
+}
+
+void Shader::set(Uniform<glm::vec3> u, glm::vec3 v) {
+  if (u.loc() != -1)
+    gl.Uniform3fv(u.loc(), 1, glm::value_ptr(v));
+}
+
+void Shader::set(Uniform<glm::vec4> u, glm::vec4 v) {
+  if (u.loc() != -1)
+    gl.Uniform4fv(u.loc(), 1, glm::value_ptr(v));
+}
+
+void Shader::set(Uniform<int> u, int v) {
+  if (u.loc() != -1)
+    gl.Uniform1i(u.loc(), v);
+}
+
+void Shader::set(Uniform<glm::ivec2> u, glm::ivec2 v) {
+  if (u.loc() != -1)
+    gl.Uniform2iv(u.loc(), 1, glm::value_ptr(v));
+}
+
+void Shader::set(Uniform<glm::ivec3> u, glm::ivec3 v) {
+  if (u.loc() != -1)
+    gl.Uniform3iv(u.loc(), 1, glm::value_ptr(v));
+}
+
+void Shader::set(Uniform<glm::ivec4> u, glm::ivec4 v) {
+  if (u.loc() != -1)
+    gl.Uniform4iv(u.loc(), 1, glm::value_ptr(v));
+}
+
+void Shader::set(Uniform<unsigned int> u, unsigned int v) {
+  if (u.loc() != -1)
+    gl.Uniform1ui(u.loc(), v);
+}
+
+void Shader::set(Uniform<glm::uvec2> u, glm::uvec2 v) {
+  if (u.loc() != -1)
+    gl.Uniform2uiv(u.loc(), 1, glm::value_ptr(v));
+}
+
+void Shader::set(Uniform<glm::uvec3> u, glm::uvec3 v) {
+  if (u.loc() != -1)
+    gl.Uniform3uiv(u.loc(), 1, glm::value_ptr(v));
+}
+
+void Shader::set(Uniform<glm::uvec4> u, glm::uvec4 v) {
+  if (u.loc() != -1)
+    gl.Uniform4uiv(u.loc(), 1, glm::value_ptr(v));
+}
+
+void Shader::set(Uniform<glm::mat2> u, const glm::mat2& v) {
+  if (u.loc() != -1)
+    gl.UniformMatrix2fv(u.loc(), 1, GL_FALSE, glm::value_ptr(v));
+}
+
+void Shader::set(Uniform<glm::mat3> u, const glm::mat3& v) {
+  if (u.loc() != -1)
+    gl.UniformMatrix3fv(u.loc(), 1, GL_FALSE, glm::value_ptr(v));
+}
+
+void Shader::set(Uniform<glm::mat4> u, const glm::mat4& v) {
+  if (u.loc() != -1)
+    gl.UniformMatrix4fv(u.loc(), 1, GL_FALSE, glm::value_ptr(v));
+}
+
 void Shader::uniform_1f(const std::string& uniform_name, float v0) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform1f(loc, v0);
 }
 
 void Shader::uniform_2f(const std::string& uniform_name, float v0, float v1) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform2f(loc, v0, v1);
 }
 
 void Shader::uniform_3f(const std::string& uniform_name, float v0, float v1, float v2) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform3f(loc, v0, v1, v2);
 }
 
 void Shader::uniform_4f(const std::string& uniform_name, float v0, float v1, float v2, float v3) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform4f(loc, v0, v1, v2, v3);
 }
 
 void Shader::uniform_1f(const std::string& uniform_name, glm::vec1 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform1fv(loc, 1, &v.x);
 }
 
 void Shader::uniform_2f(const std::string& uniform_name, glm::vec2 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform2fv(loc, 1, glm::value_ptr(v));
 }
 
 void Shader::uniform_3f(const std::string& uniform_name, glm::vec3 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform3fv(loc, 1, glm::value_ptr(v));
 }
 
 void Shader::uniform_4f(const std::string& uniform_name, glm::vec4 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform4fv(loc, 1, glm::value_ptr(v));
 }
 
 void Shader::uniform_1i(const std::string& uniform_name, int v0) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform1i(loc, v0);
 }
 
 void Shader::uniform_2i(const std::string& uniform_name, int v0, int v1) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform2i(loc, v0, v1);
 }
 
 void Shader::uniform_3i(const std::string& uniform_name, int v0, int v1, int v2) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform3i(loc, v0, v1, v2);
 }
 
 void Shader::uniform_4i(const std::string& uniform_name, int v0, int v1, int v2, int v3) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform4i(loc, v0, v1, v2, v3);
 }
 
 void Shader::uniform_1i(const std::string& uniform_name, glm::ivec1 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform1iv(loc, 1, &v.x);
 }
 
 void Shader::uniform_2i(const std::string& uniform_name, glm::ivec2 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform2iv(loc, 1, glm::value_ptr(v));
 }
 
 void Shader::uniform_3i(const std::string& uniform_name, glm::ivec3 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform3iv(loc, 1, glm::value_ptr(v));
 }
 
 void Shader::uniform_4i(const std::string& uniform_name, glm::ivec4 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform4iv(loc, 1, glm::value_ptr(v));
 }
 
 void Shader::uniform_1u(const std::string& uniform_name, unsigned int v0) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform1ui(loc, v0);
 }
 
 void Shader::uniform_2u(const std::string& uniform_name, unsigned int v0, unsigned int v1) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform2ui(loc, v0, v1);
 }
 
 void Shader::uniform_3u(const std::string& uniform_name, unsigned int v0, unsigned int v1, unsigned int v2) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform3ui(loc, v0, v1, v2);
 }
 
 void Shader::uniform_4u(const std::string& uniform_name, unsigned int v0, unsigned int v1, unsigned int v2,
                         unsigned int v3) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform4ui(loc, v0, v1, v2, v3);
 }
 
 void Shader::uniform_1u(const std::string& uniform_name, glm::uvec1 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform1uiv(loc, 1, &v.x);
 }
 
 void Shader::uniform_2u(const std::string& uniform_name, glm::uvec2 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform2uiv(loc, 1, glm::value_ptr(v));
 }
 
 void Shader::uniform_3u(const std::string& uniform_name, glm::uvec3 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform3uiv(loc, 1, glm::value_ptr(v));
 }
 
 void Shader::uniform_4u(const std::string& uniform_name, glm::uvec4 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.Uniform4uiv(loc, 1, glm::value_ptr(v));
 }
 
 void Shader::uniform_mat2f(const std::string& uniform_name, glm::mat2 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.UniformMatrix2fv(loc, 1, GL_FALSE, glm::value_ptr(v));
 }
 
 void Shader::uniform_mat3f(const std::string& uniform_name, glm::mat3 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.UniformMatrix3fv(loc, 1, GL_FALSE, glm::value_ptr(v));
 }
 
 void Shader::uniform_mat4f(const std::string& uniform_name, glm::mat4 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.UniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(v));
 }
 
 void Shader::uniform_mat2x3f(const std::string& uniform_name, glm::mat2x3 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.UniformMatrix2x3fv(loc, 1, GL_FALSE, glm::value_ptr(v));
 }
 
 void Shader::uniform_mat3x2f(const std::string& uniform_name, glm::mat3x2 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.UniformMatrix3x2fv(loc, 1, GL_FALSE, glm::value_ptr(v));
 }
 
 void Shader::uniform_mat2x4f(const std::string& uniform_name, glm::mat2x4 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.UniformMatrix2x4fv(loc, 1, GL_FALSE, glm::value_ptr(v));
 }
 
 void Shader::uniform_mat4x2f(const std::string& uniform_name, glm::mat4x2 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.UniformMatrix4x2fv(loc, 1, GL_FALSE, glm::value_ptr(v));
 }
 
 void Shader::uniform_mat3x4f(const std::string& uniform_name, glm::mat3x4 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.UniformMatrix3x4fv(loc, 1, GL_FALSE, glm::value_ptr(v));
 }
 
 void Shader::uniform_mat4x3f(const std::string& uniform_name, glm::mat4x3 v) {
-  auto loc = get_uniform_loc_(uniform_name);
+  auto loc = get_uniform_loc(uniform_name);
   if (loc != -1)
     gl.UniformMatrix4x3fv(loc, 1, GL_FALSE, glm::value_ptr(v));
 }
 
-GLint Shader::get_uniform_loc_(const std::string& uniform_name) {
+GLint Shader::get_uniform_loc(const std::string& uniform_name) {
   auto it = uniform_locs_.find(uniform_name);
   if (it != uniform_locs_.end())
     return it->second;
@@ -469,9 +682,29 @@ GLint Shader::get_uniform_loc_(const std::string& uniform_name) {
   return loc;
 }
 
+const GLint* Shader::uniform_handle_(const std::string& uniform_name) {
+  auto it = std::ranges::find(uniform_handles_, uniform_name, &std::pair<std::string, GLint>::first);
+  if (it != uniform_handles_.end())
+    return &it->second;
+
+  return &uniform_handles_.emplace_back(uniform_name, get_uniform_loc(uniform_name)).second;
+}
+
+bool Shader::bind_uniform_block_(const std::string& block_name, GLuint binding) {
+  const auto index = gl.GetUniformBlockIndex(id, block_name.c_str());
+  if (index == GL_INVALID_INDEX) {
+    IMP_LOG_WARN("Uniform block '{}' not found in shader ({}:{})", block_name, name, id);
+    return false;
+  }
+
+  gl.UniformBlockBinding(id, index, binding);
+  return true;
+}
+
 bool Shader::compile_shader_src_(const ShaderSrc& src) {
   GLuint vertex_id{0};
   GLuint fragment_id{0};
+  GLuint compute_id{0};
 
   if (src.vertex) {
     vertex_id = gl.CreateShader(GL_VERTEX_SHADER);
@@ -501,10 +734,30 @@ bool Shader::compile_shader_src_(const ShaderSrc& src) {
       return false;
   }
 
+  if (src.compute) {
+    compute_id = gl.CreateShader(GL_COMPUTE_SHADER);
+
+    const char* src_p = src.compute.value().c_str();
+    gl.ShaderSource(compute_id, 1, &src_p, nullptr);
+    gl.CompileShader(compute_id);
+
+    if (check_compile_(compute_id, GL_COMPUTE_SHADER)) {
+      gl.AttachShader(id, compute_id);
+      IMP_LOG_DEBUG("Attached compute shader ({}:{})", name, id);
+    } else
+      return false;
+  }
+
+  // Without the hint some drivers won't hand back a binary
+  if (gl.ProgramParameteri)
+    gl.ProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
   gl.LinkProgram(id);
   if (check_link_()) {
     IMP_LOG_DEBUG("Linked shader program ({}:{})", name, id);
     src_ = src;
+    linked_ = true;
+    from_binary_ = false;
   } else
     return false;
 
@@ -514,6 +767,29 @@ bool Shader::compile_shader_src_(const ShaderSrc& src) {
   if (fragment_id != 0)
     gl.DeleteShader(fragment_id);
 
+  if (compute_id != 0)
+    gl.DeleteShader(compute_id);
+
+  return true;
+}
+
+bool Shader::load_binary_(const ShaderSrc& src, const ShaderBinary& binary) {
+  if (!gl.ProgramBinary || binary.data.empty())
+    return false;
+
+  gl.ProgramBinary(id, binary.format, binary.data.data(), static_cast<GLsizei>(binary.data.size()));
+
+  GLint success = 0;
+  gl.GetProgramiv(id, GL_LINK_STATUS, &success);
+  if (!success) {
+    IMP_LOG_DEBUG("Program binary rejected, compiling from source ({}:{})", name, id);
+    return false;
+  }
+
+  IMP_LOG_DEBUG("Loaded shader program from binary ({}:{})", name, id);
+  src_ = src;
+  linked_ = true;
+  from_binary_ = true;
   return true;
 }
 
@@ -535,6 +811,9 @@ bool Shader::check_compile_(GLuint shader_id, GLenum type) {
       case GL_FRAGMENT_SHADER:
         type_str = "fragment";
         break;
+      case GL_COMPUTE_SHADER:
+        type_str = "compute";
+        break;
       default:
         std::unreachable();
     }
@@ -570,6 +849,7 @@ void Shader::gen_id_() {
 
 void Shader::del_id_(GLuint id) {
   if (id != 0) {
+    ctx.forget_program(id);
     gl.DeleteProgram(id);
     IMP_LOG_DEBUG("DEL_ID({}): Shader/{}", id, name);
     id = 0;
@@ -0,0 +1,141 @@
+#include "imp/gfx/gl/tex_array.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace imp {
+TexArray::TexArray(GfxContext& gfx, GLsizei w, GLsizei h, GLsizei capacity, bool retro)
+  : ctx(gfx), gl(gfx.gl), w(w), h(h), capacity(capacity), retro(retro) {
+  if (!retro)
+    levels_ = static_cast<GLsizei>(std::floor(std::log2(std::max(w, h)))) + 1;
+
+  gen_id_();
+  bind();
+
+  gl.TexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  gl.TexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  gl.TexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, retro ? GL_NEAREST : GL_LINEAR_MIPMAP_LINEAR);
+  gl.TexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, retro ? GL_NEAREST : GL_LINEAR);
+  gl.TexStorage3D(GL_TEXTURE_2D_ARRAY, levels_, GL_RGBA8, w, h, capacity);
+
+  IMP_LOG_DEBUG("Created texture array ({}x{}x{})", w, h, capacity);
+
+  unbind();
+}
+
+TexArray::~TexArray() {
+  del_id_();
+}
+
+TexArray::TexArray(TexArray&& other) noexcept
+  : ctx(other.ctx), gl(other.gl), id(other.id), w(other.w), h(other.h),
+    capacity(other.capacity), layer_count(other.layer_count), retro(other.retro), levels_(other.levels_) {
+  other.id = 0;
+  other.w = 0;
+  other.h = 0;
+  other.capacity = 0;
+  other.layer_count = 0;
+}
+
+TexArray& TexArray::operator=(TexArray&& other) noexcept {
+  if (this != &other) {
+    del_id_();
+
+    gl = other.gl;
+    id = other.id;
+    w = other.w;
+    h = other.h;
+    capacity = other.capacity;
+    layer_count = other.layer_count;
+    retro = other.retro;
+    levels_ = other.levels_;
+
+    other.id = 0;
+    other.w = 0;
+    other.h = 0;
+    other.capacity = 0;
+    other.layer_count = 0;
+  }
+  return *this;
+}
+
+bool TexArray::full() const {
+  return layer_count >= capacity;
+}
+
+std::optional<GLsizei> TexArray::add_layer(ImageData& image_data) {
+  if (full() || image_data.w() != w || image_data.h() != h)
+    return std::nullopt;
+
+  GLenum format;
+  if (image_data.comp() == 3)
+    format = GL_RGB;
+  else if (image_data.comp() == 4)
+    format = GL_RGBA;
+  else {
+    IMP_LOG_ERROR("Can't handle images with comp '{}', only 3 or 4 channels supported", image_data.comp());
+    return std::nullopt;
+  }
+
+  const auto layer = layer_count++;
+
+  bind();
+  gl.PixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  gl.TexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, w, h, 1, format, GL_UNSIGNED_BYTE, image_data.bytes());
+  upload_mips_(layer, format, image_data.bytes(), image_data.comp());
+  gl.PixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  unbind();
+
+  return layer;
+}
+
+void TexArray::upload_mips_(GLsizei layer, GLenum format, const unsigned char* pixels, int comp) {
+  // glGenerateMipmap would rebuild the chain of every layer in the array, empty ones included,
+  // so this layer's levels are box filtered here instead. Odd edges repeat their last texel
+  std::vector<unsigned char> prev(pixels, pixels + static_cast<std::size_t>(w) * h * comp), next;
+  GLsizei pw = w, ph = h;
+  for (GLsizei level = 1; level < levels_; ++level) {
+    const auto nw = std::max(1, pw / 2), nh = std::max(1, ph / 2);
+    next.resize(static_cast<std::size_t>(nw) * nh * comp);
+
+    for (GLsizei y = 0; y < nh; ++y) {
+      const auto* r0 = prev.data() + static_cast<std::size_t>(std::min(y * 2, ph - 1)) * pw * comp;
+      const auto* r1 = prev.data() + static_cast<std::size_t>(std::min(y * 2 + 1, ph - 1)) * pw * comp;
+      auto* out = next.data() + static_cast<std::size_t>(y) * nw * comp;
+      for (GLsizei x = 0; x < nw; ++x) {
+        const auto x0 = std::min(x * 2, pw - 1) * comp, x1 = std::min(x * 2 + 1, pw - 1) * comp;
+        for (int c = 0; c < comp; ++c)
+          out[x * comp + c] = static_cast<unsigned char>((r0[x0 + c] + r0[x1 + c] + r1[x0 + c] + r1[x1 + c] + 2) / 4);
+      }
+    }
+
+    gl.TexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, nw, nh, 1, format, GL_UNSIGNED_BYTE, next.data());
+    std::swap(prev, next);
+    pw = nw;
+    ph = nh;
+  }
+}
+
+void TexArray::bind(int unit) {
+  ctx.bind_texture(GL_TEXTURE_2D_ARRAY, id, unit);
+}
+
+void TexArray::unbind(int unit) {
+  ctx.bind_texture(GL_TEXTURE_2D_ARRAY, 0, unit);
+}
+
+void TexArray::gen_id_() {
+  gl.GenTextures(1, &id);
+  IMP_LOG_DEBUG("GEN_ID({}): TexArray", id);
+}
+
+void TexArray::del_id_() {
+  if (id != 0) {
+    ctx.forget_texture(id);
+    gl.DeleteTextures(1, &id);
+    IMP_LOG_DEBUG("DEL_ID({}): TexArray", id);
+    id = 0;
+  }
+}
+} // namespace imp
@@ -2,7 +2,7 @@
 #include "imp/util/io.hpp"
 
 namespace imp {
-TexImage::TexImage(GfxContext& gfx, const std::filesystem::path& path, bool retro) : gl(gfx.gl) {
+TexImage::TexImage(GfxContext& gfx, const std::filesystem::path& path, bool retro) : ctx(gfx), gl(gfx.gl) {
   stbi_set_flip_vertically_on_load(false);
 
   gen_id_();
@@ -49,7 +49,7 @@ TexImage::TexImage(GfxContext& gfx, const std::filesystem::path& path, bool retr
   unbind();
 }
 
-TexImage::TexImage(GfxContext& gfx, TexFormat format, GLsizei w, GLsizei h, bool retro) : gl(gfx.gl), w(w), h(h) {
+TexImage::TexImage(GfxContext& gfx, TexFormat format, GLsizei w, GLsizei h, bool retro) : ctx(gfx), gl(gfx.gl), w(w), h(h) {
   gen_id_();
   bind();
 
@@ -70,7 +70,7 @@ TexImage::~TexImage() {
 }
 
 TexImage::TexImage(TexImage&& other) noexcept
-  : gl(other.gl), id(other.id), w(other.w), h(other.h), fully_opaque(other.fully_opaque) {
+  : ctx(other.ctx), gl(other.gl), id(other.id), w(other.w), h(other.h), fully_opaque(other.fully_opaque) {
   other.id = 0;
   other.w = 0;
   other.h = 0;
@@ -96,12 +96,11 @@ TexImage& TexImage::operator=(TexImage&& other) noexcept {
 }
 
 void TexImage::bind(int unit) {
-  gl.ActiveTexture(GL_TEXTURE0 + unit);
-  gl.BindTexture(GL_TEXTURE_2D, id);
+  ctx.bind_texture(GL_TEXTURE_2D, id, unit);
 }
 
-void TexImage::unbind() {
-  gl.BindTexture(GL_TEXTURE_2D, 0);
+void TexImage::unbind(int unit) {
+  ctx.bind_texture(GL_TEXTURE_2D, 0, unit);
 }
 
 void TexImage::gen_id_() {
@@ -111,6 +110,7 @@ void TexImage::gen_id_() {
 
 void TexImage::del_id_() {
   if (id != 0) {
+    ctx.forget_texture(id);
     gl.DeleteTextures(1, &id);
     IMP_LOG_DEBUG("DEL_ID({}): TexImage", id);
     id = 0;
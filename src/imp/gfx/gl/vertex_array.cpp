@@ -3,16 +3,36 @@
 #include "imp/util/sops.hpp"
 
 namespace imp {
-VertexArray::VertexArray(GfxContext& gfx) : gl(gfx.gl) {
+VertexArray::VertexArray(GfxContext& gfx) : ctx(gfx), gl(gfx.gl) {
   gen_id_();
 }
 
+VertexArray::~VertexArray() {
+  del_id_();
+}
+
+VertexArray::VertexArray(VertexArray&& other) noexcept : ctx(other.ctx), gl(other.gl), id(other.id) {
+  other.id = 0;
+}
+
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept {
+  if (this != &other) {
+    del_id_();
+
+    gl = other.gl;
+    id = other.id;
+
+    other.id = 0;
+  }
+  return *this;
+}
+
 void VertexArray::bind() {
-  gl.BindVertexArray(id);
+  ctx.bind_vertex_array(id);
 }
 
 void VertexArray::unbind() {
-  gl.BindVertexArray(0);
+  ctx.bind_vertex_array(0);
 }
 
 void VertexArray::attrib(Shader& shader, BufTarget target, Buffer& buf, const std::string& desc) {
@@ -100,6 +120,35 @@ void VertexArray::attrib(Shader& shader, Buffer& buf, const std::string& desc) {
   attrib(shader, BufTarget::array, buf, desc);
 }
 
+void VertexArray::attrib(Shader& shader, BufTarget target, Buffer& buf, const VertexLayout& layout) {
+  const auto locs = shader.attrib_locs(layout);
+
+  bind();
+  buf.bind(target);
+  for (std::size_t i = 0; i < layout.count; ++i) {
+    if (locs[i] == -1)
+      continue;
+
+    const auto& a = layout.attribs[i];
+    const auto index = static_cast<GLuint>(locs[i]);
+    const auto offset = reinterpret_cast<void*>(static_cast<std::size_t>(a.offset));
+    // Integer inputs need the I variant, anything else would have them converted to floats
+    if (a.type != GL_FLOAT && a.normalized == GL_FALSE)
+      gl.VertexAttribIPointer(index, a.size, a.type, layout.stride, offset);
+    else
+      gl.VertexAttribPointer(index, a.size, a.type, a.normalized, layout.stride, offset);
+    if (a.divisor != 0)
+      gl.VertexAttribDivisor(index, a.divisor);
+    gl.EnableVertexAttribArray(index);
+  }
+  buf.unbind(target);
+  unbind();
+}
+
+void VertexArray::attrib(Shader& shader, Buffer& buf, const VertexLayout& layout) {
+  attrib(shader, BufTarget::array, buf, layout);
+}
+
 void VertexArray::element_array(Buffer& buf) {
   bind();
   buf.bind(BufTarget::element_array);
@@ -118,6 +167,12 @@ void VertexArray::multi_draw_arrays_indirect(const DrawMode& mode, GLsizei drawc
   unbind();
 }
 
+void VertexArray::multi_draw_elements_indirect(const DrawMode& mode, GLsizei drawcount, GLsizei stride, std::size_t offset) {
+  bind();
+  gl.MultiDrawElementsIndirect(unwrap(mode), GL_UNSIGNED_INT, reinterpret_cast<void*>(offset), drawcount, stride);
+  unbind();
+}
+
 void VertexArray::gen_id_() {
   gl.GenVertexArrays(1, &id);
   IMP_LOG_DEBUG("GEN_ID({}): Vertex array", id);
@@ -125,6 +180,7 @@ void VertexArray::gen_id_() {
 
 void VertexArray::del_id_() {
   if (id != 0) {
+    ctx.forget_vertex_array(id);
     gl.DeleteVertexArrays(1, &id);
     IMP_LOG_DEBUG("DEL_ID({}): Vertex array", id);
     id = 0;
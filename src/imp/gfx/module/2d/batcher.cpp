@@ -1,189 +1,797 @@
 #include "imp/gfx/module/2d/batcher.hpp"
 
 #include "imp/util/io.hpp"
+#include "imp/util/radix_sort.hpp"
+#include "glm/gtc/type_ptr.hpp"
+#include "imgui.h"
+#include <cassert>
+#include <cmath>
+#include <limits>
 #include <ranges>
 
 namespace imp {
-Batch::Batch(
-  GfxContext& ctx,
-  Shader& shader,
-  const DrawMode draw_mode, const std::string& attrib_desc,
-  std::size_t vertices_per_obj, std::size_t floats_per_vertex, bool fill_reverse
-) : shader_(shader),
-    vao_(ctx),
-    vbo_(ctx, vertices_per_obj * floats_per_vertex, false, BufTarget::array, BufUsage::dynamic_draw),
-    ebo_(ctx, vertices_per_obj, fill_reverse, BufTarget::element_array, BufUsage::dynamic_draw),
-    draw_mode_(draw_mode),
-    floats_per_vertex_(floats_per_vertex),
-    fill_reverse_(fill_reverse) {
-  vao_.attrib(shader, vbo_, attrib_desc);
-  vao_.element_array(ebo_);
+Batch::Batch(DrawMode draw_mode, std::size_t fpv, bool fill_reverse)
+  : draw_mode_(draw_mode),
+    floats_per_vertex_(fpv),
+    fill_reverse_(fill_reverse) {}
+
+void Batch::begin(const BatchStorage& s) {
+  base_vertex_ = static_cast<GLint>(s.vbo.size() / floats_per_vertex_);
+  vertex_count_ = 0;
+  indices_before_ = s.ebo.size();
+  indices_ = 0;
+  draw_start_offset_ = 0;
+  quads_only_ = s.quad_vao.has_value();
+  quads_ = 0;
 }
 
 std::size_t Batch::size() const {
-  return vbo_.size();
+  return vertex_count_ * floats_per_vertex_;
 }
 
-void Batch::clear() {
-  vbo_.clear();
-  ebo_.clear();
-  draw_start_offset_ = 0;
-  ebo_offset_ = 0;
-}
+void Batch::add(BatchStorage& s, std::span<const float> data, std::span<const unsigned int> indices,
+                bool insert_restart) {
+  if (quads_only_) {
+    if (is_quad(data, indices, floats_per_vertex_, insert_restart)) {
+      s.vbo.add(data);
+      vertex_count_ += 4;
+      quads_++;
+      return;
+    }
 
-void Batch::add(std::initializer_list<float> data, std::initializer_list<unsigned int> indices, bool insert_restart) {
-  vbo_.add(data);
+    // Quads so far keep the same index positions, so ranges already recorded stay valid
+    quads_only_ = false;
+    for (std::size_t q = 0; q < quads_; ++q) {
+      const auto v = static_cast<unsigned int>(q * 4);
+      s.ebo.add({v, v + 1, v + 2, v, v + 2, v + 3});
+    }
+    indices_ += quads_ * 6;
+  }
+
+  s.vbo.add(data);
   if (insert_restart) {
-    ebo_.add({std::numeric_limits<GLuint>::max()});
+    s.ebo.add({std::numeric_limits<GLuint>::max()});
+    indices_++;
   }
-  ebo_.add(std::ranges::views::transform(indices, [&](const auto& i) { return i + ebo_offset_; }));
-  ebo_offset_ += data.size() / floats_per_vertex_;
+  s.ebo.add(std::ranges::views::transform(indices, [&](const auto& i) { return i + vertex_count_; }));
+  indices_ += indices.size();
+  vertex_count_ += data.size() / floats_per_vertex_;
+}
+
+std::size_t Batch::quads() const {
+  return quads_;
 }
 
-DrawCall Batch::get_draw_call_tex(GLuint id) {
-  int count, first;
+void Batch::record(const BatchStorage& s, RenderCmdBuffer& cmds) {
+  std::size_t count, first;
   if (fill_reverse_) {
-    count = ebo_.size();
-    first = ebo_.front();
+    // Later batches sit in front of this one
+    count = indices_;
+    first = s.ebo.front() + (s.ebo.size() - indices_before_ - indices_);
   } else {
-    count = ebo_.size() - draw_start_offset_;
-    first = draw_start_offset_;
-    draw_start_offset_ = ebo_.size();
+    count = index_count_() - draw_start_offset_;
+    first = quads_only_ ? draw_start_offset_ : indices_before_ + draw_start_offset_;
+    draw_start_offset_ = index_count_();
   }
 
-  return [&, id, count, first](GladGLContext& gl_, glm::mat4 mvp, float z_max) {
-    vbo_.sync();
-    ebo_.sync();
+  if (count == 0)
+    return;
 
-    shader_.use();
-    shader_.uniform_mat4f("mvp", mvp);
-    shader_.uniform_1f("z_max", z_max);
-
-    gl_.BindTexture(GL_TEXTURE_2D, id);
-
-    vao_.bind();
-    vao_.gl.DrawElements(
-      unwrap(draw_mode_),
-      count,
-      GL_UNSIGNED_INT,
-      reinterpret_cast<void*>(first * sizeof(unsigned int))
-    );
-    vao_.unbind();
-  };
+  cmds.bind_vao(quads_only_ ? s.quad_vao->id : s.vao.id);
+  cmds.draw_elements(draw_mode_, static_cast<GLsizei>(count), static_cast<GLsizei>(first), base_vertex_);
 }
 
-DrawCall Batch::get_draw_call() {
-  return get_draw_call_tex(0);
+std::size_t Batch::index_count_() const {
+  return quads_only_ ? quads_ * 6 : indices_;
 }
 
 BatchList::BatchList(
   GfxContext& ctx,
   Shader& shader,
-  const DrawMode draw_mode, const std::string& attrib_desc,
-  std::size_t vertices_per_obj, std::size_t floats_per_vertex, bool fill_reverse
-) : ctx_(ctx),
-    shader_(shader),
+  const DrawMode draw_mode, const VertexLayout& layout,
+  std::size_t vertices_per_obj, bool fill_reverse,
+  TexTarget tex_target, QuadIndexBuffer* quad_ebo
+) : shader_(shader),
     draw_mode_(draw_mode),
-    vertices_per_obj_(vertices_per_obj),
-    attrib_desc_(attrib_desc),
-    floats_per_vertex_(floats_per_vertex),
-    fill_reverse_(fill_reverse) {}
+    floats_per_vertex_(floats_per_vertex(layout)),
+    fill_reverse_(fill_reverse),
+    tex_target_(tex_target),
+    quad_ebo_(fill_reverse ? nullptr : quad_ebo) {
+  initial_vertices_ = vertices_per_obj * floats_per_vertex_;
+  initial_indices_ = vertices_per_obj;
+
+  sets_.reserve(BATCH_STORAGE_SETS);
+  for (std::size_t i = 0; i < BATCH_STORAGE_SETS; ++i) {
+    auto& s = sets_.emplace_back(
+      VertexArray(ctx),
+      FVBuffer(ctx, initial_vertices_, false, BufTarget::array, BufUsage::dynamic_draw),
+      UVBuffer(ctx, initial_indices_, fill_reverse, BufTarget::element_array, BufUsage::dynamic_draw)
+    );
+    s.vao.attrib(shader, s.vbo, layout);
+    s.vao.element_array(s.ebo);
+
+    // Same vertices, but indexed by the shared quad buffer
+    if (quad_ebo_) {
+      s.quad_vao.emplace(ctx);
+      s.quad_vao->attrib(shader, s.vbo, layout);
+      s.quad_vao->element_array(*quad_ebo_);
+    }
+  }
+
+  model_ = shader.uniform<glm::mat4>("model");
+}
 
 std::size_t BatchList::size() const {
-  return batches_[curr_batch_].size();
+  return batches_.empty() ? 0 : batches_[curr_batch_].size();
 }
 
 void BatchList::clear() {
-  std::ranges::for_each(batches_, [](auto& b) { b.clear(); });
+  frame_vertices_ = std::max(frame_vertices_, storage_().vbo.size());
+  frame_indices_ = std::max(frame_indices_, storage_().ebo.size());
+  if (storage_().vbo.size() > 0)
+    frame_batches_ = std::max(frame_batches_, curr_batch_ + 1);
+
+  storage_().vbo.clear();
+  storage_().ebo.clear();
   curr_batch_ = 0;
-  stored_draw_calls_.clear();
+  stored_batches_.clear();
+  if (!batches_.empty())
+    batches_[0].begin(storage_());
 }
 
-void BatchList::add_tex(GLuint id, std::initializer_list<float> data, std::initializer_list<unsigned> indices,
+void BatchList::add_tex(GLuint id, std::span<const float> data, std::span<const unsigned int> indices,
                         bool insert_restart) {
   if (batches_.empty()) {
-    batches_.emplace_back(ctx_, shader_, draw_mode_, attrib_desc_, vertices_per_obj_, floats_per_vertex_,
-                          fill_reverse_);
+    batches_.emplace_back(draw_mode_, floats_per_vertex_, fill_reverse_).begin(storage_());
   } else if (batches_[curr_batch_].size() > BATCH_SIZE_LIMIT) {
-    stored_draw_calls_.emplace_back(batches_[curr_batch_].get_draw_call_tex(id));
+    // Nothing else goes into this batch for the rest of the frame, so the range can be recorded later
+    stored_batches_.emplace_back(curr_batch_);
 
-    if (curr_batch_ == batches_.size() - 1) {
-      batches_.emplace_back(ctx_, shader_, draw_mode_, attrib_desc_, vertices_per_obj_, floats_per_vertex_,
-                            fill_reverse_);
-    }
+    if (curr_batch_ == batches_.size() - 1)
+      batches_.emplace_back(draw_mode_, floats_per_vertex_, fill_reverse_);
     curr_batch_++;
+    batches_[curr_batch_].begin(storage_());
   }
 
-  batches_[curr_batch_].add(data, indices, insert_restart);
+  batches_[curr_batch_].add(storage_(), data, indices, insert_restart);
 }
 
-void BatchList::add(std::initializer_list<float> data, std::initializer_list<unsigned int> indices,
+void BatchList::add(std::span<const float> data, std::span<const unsigned int> indices,
                     bool insert_restart) {
   add_tex(0, data, indices, insert_restart);
 }
 
-std::vector<DrawCall> BatchList::get_draw_calls_tex(GLuint id) {
-  std::vector<DrawCall> draw_calls{};
+void BatchList::sync() {
+  auto& s = storage_();
+  s.vbo.sync();
 
-  if (!stored_draw_calls_.empty()) {
-    draw_calls.insert(draw_calls.begin(), stored_draw_calls_.begin(), stored_draw_calls_.end());
-    stored_draw_calls_.clear();
+  // Every batch's quads start at the front of the shared indices. Ranges recorded while still in
+  // quad mode index it even after the batch leaves it, so it has to cover them either way
+  if (quad_ebo_) {
+    std::size_t quads = 0;
+    for (std::size_t i = 0; i <= curr_batch_ && i < batches_.size(); ++i)
+      quads = std::max(quads, batches_[i].quads());
+    if (quads > 0)
+      quad_ebo_->reserve(quads);
   }
 
-  if (!batches_.empty()) {
-    draw_calls.emplace_back(batches_[curr_batch_].get_draw_call_tex(id));
+  if (s.ebo.size() > 0)
+    s.ebo.sync();
+}
+
+std::size_t BatchList::swap() {
+  clear();
+  vertex_peak_.update(static_cast<double>(frame_vertices_));
+  index_peak_.update(static_cast<double>(frame_indices_));
+  batch_peak_.update(static_cast<double>(frame_batches_));
+  frame_vertices_ = 0;
+  frame_indices_ = 0;
+  frame_batches_ = 0;
+
+  set_ = (set_ + 1) % sets_.size();
+  clear();
+  trim_();
+  if (!batches_.empty())
+    batches_[0].begin(storage_());
+
+  // Batches past the most any frame in the window needed are released from the back. The first
+  // batch stays, it's the one every frame starts in
+  std::size_t released = 0;
+  if (batch_peak_.full()) {
+    const auto keep = std::max<std::size_t>(1, static_cast<std::size_t>(batch_peak_.value()));
+    while (batches_.size() > keep) {
+      batches_.pop_back();
+      released++;
+    }
+  }
+  return released;
+}
+
+std::size_t BatchList::cpu_bytes() const {
+  std::size_t bytes = 0;
+  for (const auto& s: sets_)
+    bytes += s.vbo.cpu_bytes() + s.ebo.cpu_bytes();
+  return bytes;
+}
+
+std::size_t BatchList::gpu_bytes() const {
+  std::size_t bytes = 0;
+  for (const auto& s: sets_)
+    bytes += s.vbo.gpu_bytes() + s.ebo.gpu_bytes();
+  return bytes;
+}
+
+void BatchList::record(RenderCmdBuffer& cmds, GLuint tex_id, bool reverse) {
+  if (batches_.empty())
+    return;
+
+  cmds.bind_program(shader_.id);
+  cmds.set_transform(model_.loc());
+  cmds.bind_texture(unwrap(tex_target_), tex_id);
+
+  const auto& s = storage_();
+  if (reverse) {
+    batches_[curr_batch_].record(s, cmds);
+    for (const auto i: stored_batches_ | std::views::reverse)
+      batches_[i].record(s, cmds);
+  } else {
+    for (const auto i: stored_batches_)
+      batches_[i].record(s, cmds);
+    batches_[curr_batch_].record(s, cmds);
   }
+  stored_batches_.clear();
+}
+
+BatchStorage& BatchList::storage_() {
+  return sets_[set_];
+}
+
+const BatchStorage& BatchList::storage_() const {
+  return sets_[set_];
+}
+
+void BatchList::trim_() {
+  // Until the window has filled up there's no telling what a normal frame looks like
+  if (!vertex_peak_.full())
+    return;
+
+  // Leave some headroom over the peak, and only bother when it gives back at least half
+  const auto trim = [](auto& buf, std::size_t initial, const WindowMax& peak) {
+    const auto p = static_cast<std::size_t>(peak.value());
+    const auto target = std::max(initial, p + p / 4);
+    if (buf.capacity() > 2 * target)
+      buf.shrink(target);
+  };
+  trim(storage_().vbo, initial_vertices_, vertex_peak_);
+  trim(storage_().ebo, initial_indices_, index_peak_);
+}
+
+thread_local BatchRecorder* BatchRecorder::active_{nullptr};
+
+BatchRecorder::Scope::Scope(BatchRecorder& recorder) : prev_(active_) {
+  active_ = &recorder;
+}
+
+BatchRecorder::Scope::~Scope() {
+  active_ = prev_;
+}
 
-  return draw_calls;
+bool BatchRecorder::retaining() {
+  return active_ && active_->retained_;
 }
 
-std::vector<DrawCall> BatchList::get_draw_calls() {
-  return get_draw_calls_tex(0);
+std::size_t BatchRecorder::size() const {
+  return prims_.size();
+}
+
+void BatchRecorder::clear() {
+  prims_.clear();
+  vertices_.clear();
+  indices_.clear();
+  z = 0.0f;
+}
+
+void BatchRecorder::add_(DrawMode mode, bool trans, TexTarget target, GLuint id,
+                         std::span<const float> data, std::span<const unsigned int> indices, bool insert_restart) {
+  prims_.emplace_back(
+    mode, trans, target, id, insert_restart,
+    vertices_.size(), data.size(),
+    indices_.size(), indices.size()
+  );
+  vertices_.insert(vertices_.end(), data.begin(), data.end());
+  indices_.insert(indices_.end(), indices.begin(), indices.end());
+  z += 1.0f;
+}
+
+BatchRecorder::Scope StaticBatch::record() {
+  recorder_.clear();
+  recorder_.retained_ = true;
+  valid_ = true;
+  dirty_ = true;
+  return BatchRecorder::Scope(recorder_);
+}
+
+void StaticBatch::invalidate() {
+  valid_ = false;
+}
+
+bool StaticBatch::valid() const {
+  return valid_;
+}
+
+std::size_t StaticBatch::z_span() const {
+  return z_span_;
 }
 
 Batcher::Batcher(const std::weak_ptr<ModuleMgr>& module_mgr) : Module(module_mgr) {
   ctx = module_mgr.lock()->get<GfxContext>();
   shaders = module_mgr.lock()->get<ShaderMgr>();
 
-  if (const auto src = ShaderSrc::parse(DATA_FOLDER / "shader" / "points.glsl")) {
+  if (const auto src = shaders->parse(DATA_FOLDER / "shader" / "points.glsl")) {
     auto points_shader = shaders->compile(*src);
 
     shaders_.emplace(DrawMode::points, points_shader);
-    attrib_descs_.emplace(DrawMode::points, "in_pos:3f in_color:4f");
+    layouts_.emplace(DrawMode::points, &BATCH_FLAT_VERTEX);
     vertices_per_obj_.emplace(DrawMode::points, 1);
-    floats_per_vertex_.emplace(DrawMode::points, 7);
+    floats_per_vertex_.emplace(DrawMode::points, floats_per_vertex(BATCH_FLAT_VERTEX));
   }
 
-  if (const auto src = ShaderSrc::parse(DATA_FOLDER / "shader" / "lines.glsl")) {
+  if (const auto src = shaders->parse(DATA_FOLDER / "shader" / "lines.glsl")) {
     auto lines_shader = shaders->compile(*src);
 
     shaders_.emplace(DrawMode::lines, lines_shader);
-    attrib_descs_.emplace(DrawMode::lines, "in_pos:3f in_color:4f in_trans:3f");
+    layouts_.emplace(DrawMode::lines, &BATCH_VERTEX);
     vertices_per_obj_.emplace(DrawMode::lines, 2);
-    floats_per_vertex_.emplace(DrawMode::lines, 10);
+    floats_per_vertex_.emplace(DrawMode::lines, floats_per_vertex(BATCH_VERTEX));
 
     shaders_.emplace(DrawMode::line_loop, lines_shader);
-    attrib_descs_.emplace(DrawMode::line_loop, "in_pos:3f in_color:4f in_trans:3f");
+    layouts_.emplace(DrawMode::line_loop, &BATCH_VERTEX);
     vertices_per_obj_.emplace(DrawMode::line_loop, 5);
-    floats_per_vertex_.emplace(DrawMode::line_loop, 10);
+    floats_per_vertex_.emplace(DrawMode::line_loop, floats_per_vertex(BATCH_VERTEX));
   }
 
-  if (const auto src = ShaderSrc::parse(DATA_FOLDER / "shader" / "triangles.glsl")) {
+  if (const auto src = shaders->parse(DATA_FOLDER / "shader" / "triangles.glsl")) {
     auto triangles_shader = shaders->compile(*src);
 
     shaders_.emplace(DrawMode::triangles, triangles_shader);
-    attrib_descs_.emplace(DrawMode::triangles, "in_pos:3f in_color:4f in_trans:3f");
+    layouts_.emplace(DrawMode::triangles, &BATCH_VERTEX);
     vertices_per_obj_.emplace(DrawMode::triangles, 3);
-    floats_per_vertex_.emplace(DrawMode::triangles, 10);
+    floats_per_vertex_.emplace(DrawMode::triangles, floats_per_vertex(BATCH_VERTEX));
   }
 
-  if (const auto src = ShaderSrc::parse(DATA_FOLDER / "shader" / "textures.glsl")) {
+  if (const auto src = shaders->parse(DATA_FOLDER / "shader" / "lines_flat.glsl")) {
+    auto lines_shader = shaders->compile(*src);
+    flat_shaders_.emplace(DrawMode::lines, lines_shader);
+    flat_shaders_.emplace(DrawMode::line_loop, lines_shader);
+  }
+
+  if (const auto src = shaders->parse(DATA_FOLDER / "shader" / "triangles_flat.glsl")) {
+    flat_shaders_.emplace(DrawMode::triangles, shaders->compile(*src));
+  }
+
+  if (const auto src = shaders->parse(DATA_FOLDER / "shader" / "textures.glsl")) {
     tex_shader_ = shaders->compile(*src);
   }
+
+  if (const auto src = shaders->parse(DATA_FOLDER / "shader" / "textures_array.glsl")) {
+    tex_array_shader_ = shaders->compile(*src);
+  }
+
+  if (const auto src = shaders->parse(DATA_FOLDER / "shader" / "textures_flat.glsl")) {
+    tex_flat_shader_ = shaders->compile(*src);
+  }
+
+  if (const auto src = shaders->parse(DATA_FOLDER / "shader" / "textures_array_flat.glsl")) {
+    tex_array_flat_shader_ = shaders->compile(*src);
+  }
+
+  // Pulling needs shader storage buffers, no point compiling it for anything older
+  if (ctx->version.x > 4 || (ctx->version.x == 4 && ctx->version.y >= 3)) {
+    if (const auto src = shaders->parse(DATA_FOLDER / "shader" / "textures_pulled.glsl")) {
+      tex_pulled_shader_ = shaders->compile(*src);
+      tex_pulled_model_ = tex_pulled_shader_->uniform<glm::mat4>("model");
+      empty_vao_.emplace(*ctx);
+      sprite_ssbo_.emplace(*ctx);
+    }
+  }
+
+  // Every batcher shader reads the projection and z_max from the same uniform buffer
+  frame_ubo_.emplace(*ctx, BufTarget::uniform, BufUsage::dynamic_draw, frame_block_);
+  for (const auto& shader: shaders_ | std::views::values)
+    shader->uniform_block("Frame", BATCH_FRAME_BINDING);
+  for (const auto& shader: flat_shaders_ | std::views::values)
+    shader->uniform_block("Frame", BATCH_FRAME_BINDING);
+  for (const auto& shader: {tex_shader_, tex_array_shader_, tex_flat_shader_, tex_array_flat_shader_, tex_pulled_shader_})
+    if (shader)
+      shader->uniform_block("Frame", BATCH_FRAME_BINDING);
+
+  quad_ebo_.emplace(*ctx);
+
+  // 64 commands to start, it grows like any other VecBuffer
+  for (std::size_t i = 0; i < BATCH_STORAGE_SETS; ++i)
+    indirect_.emplace_back(*ctx, 64 * 5, false, BufTarget::draw_indirect, BufUsage::stream_draw);
+  multi_draw_ = ctx->gl.MultiDrawElementsIndirect != nullptr;
+
+  ctx->debug_overlay->add_tab(module_name, [&] {
+    ImGui::Separator();
+
+    if (bool v = is_multi_draw(); ImGui::Checkbox("Multi-draw", &v)) {
+      set_multi_draw(v);
+    }
+    if (bool v = is_vertex_pulling(); ImGui::Checkbox("Vertex pulling", &v)) {
+      set_vertex_pulling(v);
+    }
+    if (bool v = is_cpu_transform(); ImGui::Checkbox("CPU transform", &v)) {
+      set_cpu_transform(v);
+    }
+    ImGui::Text("Draw calls: %zu", cmd_stats_.draws);
+    ImGui::Text("Ranges drawn: %zu", cmd_stats_.ranges);
+    ImGui::Text("State changes issued: %zu", cmd_stats_.issued);
+    ImGui::Text("State changes elided: %zu", cmd_stats_.elided);
+
+    ImGui::Separator();
+
+    constexpr auto mb = 1024.0 * 1024.0;
+    const auto mode_bytes = [&](DrawMode mode) {
+      std::size_t cpu = 0, gpu = 0;
+      for (const auto* batches: {&opaque_batches_, &trans_batches_}) {
+        if (auto it = batches->find(mode); it != batches->end()) {
+          cpu += it->second.cpu_bytes();
+          gpu += it->second.gpu_bytes();
+        }
+      }
+      return std::pair{cpu, gpu};
+    };
+    for (const auto& [mode, name]: {
+           std::pair{DrawMode::points, "points"},
+           std::pair{DrawMode::lines, "lines"},
+           std::pair{DrawMode::line_loop, "line loops"},
+           std::pair{DrawMode::triangles, "triangles"},
+         }) {
+      const auto [cpu, gpu] = mode_bytes(mode);
+      ImGui::Text("%s: %.2f MB CPU, %.2f MB GPU", name, cpu / mb, gpu / mb);
+    }
+
+    std::size_t tex_cpu = 0, tex_gpu = 0;
+    for (const auto& b: tex_batches_ | std::views::values) {
+      tex_cpu += b.cpu_bytes();
+      tex_gpu += b.gpu_bytes();
+    }
+    ImGui::Text("textures: %.2f MB CPU, %.2f MB GPU", tex_cpu / mb, tex_gpu / mb);
+    ImGui::Text("Idle batches released: %zu", batches_released_);
+  });
+
+  IMP_HERMES_SUB(E_EndFrame, module_name, r_end_frame_);
+}
+
+void Batcher::set_sorted(bool sorted) {
+  sorted_ = sorted;
+}
+
+bool Batcher::is_sorted() const {
+  return sorted_;
+}
+
+void Batcher::set_multi_draw(bool multi_draw) {
+  if (multi_draw && !ctx->gl.MultiDrawElementsIndirect) {
+    IMP_LOG_WARN("glMultiDrawElementsIndirect isn't available, multi-draw stays off");
+    return;
+  }
+  multi_draw_ = multi_draw;
+}
+
+bool Batcher::is_multi_draw() const {
+  return multi_draw_;
+}
+
+void Batcher::set_vertex_pulling(bool vertex_pulling) {
+  if (vertex_pulling && !(tex_pulled_shader_ && tex_pulled_shader_->linked())) {
+    IMP_LOG_WARN("Vertex pulling needs OpenGL 4.3, it stays off");
+    return;
+  }
+  vertex_pulling_ = vertex_pulling;
+}
+
+bool Batcher::is_vertex_pulling() const {
+  return vertex_pulling_;
+}
+
+void Batcher::set_cpu_transform(bool cpu_transform) {
+  cpu_transform_next_ = cpu_transform;
+}
+
+bool Batcher::is_cpu_transform() const {
+  return cpu_transform_next_;
+}
+
+float Batcher::current_z() const {
+  if (const auto* r = BatchRecorder::active_)
+    return r->z;
+  return z;
+}
+
+BatchRecorder& Batcher::create_recorder() {
+  if (recorders_used_ == recorders_.size())
+    recorders_.emplace_back(std::make_unique<BatchRecorder>());
+
+  auto& r = *recorders_[recorders_used_++];
+  r.clear();
+  return r;
+}
+
+void Batcher::merge_recorders() {
+  for (std::size_t i = 0; i < recorders_used_; ++i) {
+    auto& r = *recorders_[i];
+
+    for (const auto& p: r.prims_) {
+      const auto fpv = p.mode == DrawMode::tex ? floats_per_vertex(BATCH_TEX_VERTEX) : floats_per_vertex_[p.mode];
+
+      // Rebase the recorder's z onto ours, z is always the third float of a vertex
+      auto data = std::span(r.vertices_).subspan(p.v_first, p.v_count);
+      for (std::size_t v = 2; v < data.size(); v += fpv)
+        data[v] = z;
+
+      route_(p.mode, p.trans, p.tex_target, p.tex_id,
+             data, std::span(r.indices_).subspan(p.i_first, p.i_count), p.insert_restart);
+      z += 1.0f;
+    }
+
+    r.clear();
+  }
+  recorders_used_ = 0;
+}
+
+std::shared_ptr<StaticBatch> Batcher::create_static() {
+  return std::make_shared<StaticBatch>();
+}
+
+void Batcher::add_static(StaticBatch& batch, const glm::mat4& transform, float z_offset) {
+  if (BatchRecorder::active_) {
+    IMP_LOG_ERROR("Static batches can't be added while recording");
+    return;
+  }
+
+  if (batch.dirty_) {
+    build_static_(batch);
+    batch.dirty_ = false;
+  }
+
+  for (auto& g: batch.groups_) {
+    auto& cmds = g.trans ? trans_cmds_ : opaque_cmds_;
+
+    // Anything transparent added before this has to be drawn first
+    if (g.trans)
+      record_trans_();
+
+    cmds.bind_program(g.program);
+    cmds.set_transform(g.model.loc(), transform, z + z_offset);
+    cmds.bind_texture(unwrap(g.tex_target), g.tex_id);
+    cmds.bind_vao(g.vao.id);
+    cmds.draw_elements(g.mode, g.count, 0);
+  }
+
+  z += static_cast<float>(batch.z_span_);
 }
 
 void Batcher::add_opaque(const DrawMode& mode, const std::initializer_list<float> data,
                          std::initializer_list<unsigned int> indices, bool insert_restart) {
+  add_opaque(mode, std::span(data.begin(), data.size()), std::span(indices.begin(), indices.size()), insert_restart);
+}
+
+void Batcher::add_trans(const DrawMode& mode, std::initializer_list<float> data,
+                        std::initializer_list<unsigned int> indices, bool insert_restart) {
+  add_trans(mode, std::span(data.begin(), data.size()), std::span(indices.begin(), indices.size()), insert_restart);
+}
+
+void Batcher::add_opaque(const DrawMode& mode, std::span<const float> data,
+                         std::span<const unsigned int> indices, bool insert_restart) {
+  if (auto* r = BatchRecorder::active_) {
+    r->add_(mode, false, TexTarget::tex_2d, 0, data, indices, insert_restart);
+    return;
+  }
+
+  route_(mode, false, TexTarget::tex_2d, 0, data, indices, insert_restart);
+  z += 1.0f;
+}
+
+void Batcher::add_trans(const DrawMode& mode, std::span<const float> data,
+                        std::span<const unsigned int> indices, bool insert_restart) {
+  if (auto* r = BatchRecorder::active_) {
+    r->add_(mode, true, TexTarget::tex_2d, 0, data, indices, insert_restart);
+    return;
+  }
+
+  route_(mode, true, TexTarget::tex_2d, 0, data, indices, insert_restart);
+  z += 1.0f;
+}
+
+void Batcher::add_opaque_tex(GLuint id, std::initializer_list<float> data, std::initializer_list<unsigned> indices) {
+  add_opaque_tex(TexTarget::tex_2d, id, data, indices);
+}
+
+void Batcher::add_trans_tex(GLuint id, std::initializer_list<float> data, std::initializer_list<unsigned> indices) {
+  add_trans_tex(TexTarget::tex_2d, id, data, indices);
+}
+
+void Batcher::add_opaque_tex(TexTarget target, GLuint id, std::initializer_list<float> data,
+                             std::initializer_list<unsigned> indices) {
+  add_trans_tex(target, id, data, indices);  // TODO: Specialize so we can take advantage of z ordering here
+}
+
+void Batcher::add_trans_tex(TexTarget target, GLuint id, std::initializer_list<float> data,
+                            std::initializer_list<unsigned> indices) {
+  if (auto* r = BatchRecorder::active_) {
+    r->add_(DrawMode::tex, true, target, id, data, indices, false);
+    return;
+  }
+
+  route_(DrawMode::tex, true, target, id, data, indices, false);
+  z += 1.0f;
+}
+
+bool Batcher::add_sprite(GLuint id, glm::vec4 rect, glm::vec2 pivot, float angle, const glm::vec4& color) {
+  if (!vertex_pulling_ || sorted_ || BatchRecorder::active_)
+    return false;
+
+  push_sprite_(id, {rect, pivot, angle, z, color});
+  z += 1.0f;
+  return true;
+}
+
+void Batcher::draw(const glm::mat4& projection) {
+  if (recorders_used_ > 0)
+    merge_recorders();
+
+  if (!sort_items_.empty())
+    replay_sorted_();
+
+  record_opaque_();
+  record_trans_();
+  sync_();
+  sync_sprites_();
+
+  cmd_stats_ = execute_(opaque_cmds_, trans_cmds_, projection, z);
+  clear_opaque_();
+  clear_trans_();
+
+  // The batches were built for the other vertex layout, they're rebuilt as they're needed
+  if (cpu_transform_ != cpu_transform_next_) {
+    cpu_transform_ = cpu_transform_next_;
+    opaque_batches_.clear();
+    trans_batches_.clear();
+    tex_batches_.clear();
+  }
+
+  z = 1.0f;
+}
+
+void Batcher::draw_static(StaticBatch& batch, const glm::mat4& projection) {
+  if (BatchRecorder::active_) {
+    IMP_LOG_ERROR("Static batches can't be drawn while recording");
+    return;
+  }
+
+  if (batch.dirty_) {
+    build_static_(batch);
+    batch.dirty_ = false;
+  }
+
+  // Recorded z starts at 0, shift it up to 1 like a normal frame
+  RenderCmdBuffer opaque, trans;
+  for (auto& g: batch.groups_) {
+    auto& cmds = g.trans ? trans : opaque;
+    cmds.bind_program(g.program);
+    cmds.set_transform(g.model.loc(), glm::mat4(1.0f), 1.0f);
+    cmds.bind_texture(unwrap(g.tex_target), g.tex_id);
+    cmds.bind_vao(g.vao.id);
+    cmds.draw_elements(g.mode, g.count, 0);
+  }
+
+  execute_(opaque, trans, projection, static_cast<float>(batch.z_span_) + 1.0f);
+}
+
+void Batcher::build_static_(StaticBatch& batch) {
+  struct Staging_ {
+    DrawMode mode;
+    bool trans;
+    TexTarget tex_target;
+    GLuint tex_id;
+    std::vector<float> vertices{};
+    std::vector<unsigned int> indices{};
+    bool quads{true};
+  };
+  std::vector<Staging_> staging{};
+
+  const auto& r = batch.recorder_;
+  for (const auto& p: r.prims_) {
+    const auto same_state = [&](const Staging_& s) {
+      return s.mode == p.mode && s.trans == p.trans && s.tex_target == p.tex_target && s.tex_id == p.tex_id;
+    };
+
+    // Opaque primitives can go into any group with the same state, transparent ones can only
+    // extend the last group, otherwise they would draw out of order
+    Staging_* s = nullptr;
+    if (p.trans) {
+      if (!staging.empty() && same_state(staging.back()))
+        s = &staging.back();
+    } else if (auto it = std::ranges::find_if(staging, same_state); it != staging.end())
+      s = &*it;
+
+    if (!s)
+      s = &staging.emplace_back(p.mode, p.trans, p.tex_target, p.tex_id);
+
+    const auto fpv = p.mode == DrawMode::tex ? floats_per_vertex(BATCH_TEX_VERTEX) : floats_per_vertex_[p.mode];
+    const auto offset = static_cast<unsigned int>(s->vertices.size() / fpv);
+    const auto indices = std::span(r.indices_).subspan(p.i_first, p.i_count);
+    const auto data = std::span(r.vertices_).subspan(p.v_first, p.v_count);
+
+    s->quads = s->quads && is_quad(data, indices, fpv, p.insert_restart);
+
+    if (p.insert_restart)
+      s->indices.emplace_back(std::numeric_limits<GLuint>::max());
+    for (const auto i: indices)
+      s->indices.emplace_back(i + offset);
+
+    s->vertices.insert(s->vertices.end(), data.begin(), data.end());
+  }
+
+  batch.groups_.clear();
+  for (const auto& s: staging) {
+    Shader* shader;
+    const VertexLayout* layout;
+    if (s.mode == DrawMode::tex) {
+      shader = s.tex_target == TexTarget::tex_2d_array ? tex_array_shader_.get() : tex_shader_.get();
+      layout = &BATCH_TEX_VERTEX;
+    } else {
+      shader = shaders_[s.mode].get();
+      layout = layouts_[s.mode];
+    }
+
+    // A group of nothing but quads has exactly the shared indices, so it doesn't upload its own
+    const auto count = static_cast<GLsizei>(s.indices.size());
+
+    auto& g = batch.groups_.emplace_back(
+      s.mode == DrawMode::tex ? DrawMode::triangles : s.mode,
+      s.trans,
+      s.tex_target,
+      s.tex_id,
+      shader->id,
+      shader->uniform<glm::mat4>("model"),
+      VertexArray(*ctx),
+      FSBuffer(*ctx, BufTarget::array, BufUsage::static_draw, s.vertices),
+      USBuffer(*ctx, BufTarget::element_array, BufUsage::static_draw, s.quads ? std::vector<unsigned int>{} : s.indices),
+      count
+    );
+    g.vao.attrib(*shader, g.vbo, *layout);
+    if (s.quads) {
+      quad_ebo_->reserve(count / 6);
+      g.vao.element_array(*quad_ebo_);
+    } else
+      g.vao.element_array(g.ebo);
+  }
+
+  batch.z_span_ = r.prims_.size();
+  batch.recorder_.clear();
+}
+
+void Batcher::route_(DrawMode mode, bool trans, TexTarget target, GLuint id,
+                     std::span<const float> data, std::span<const unsigned int> indices, bool insert_restart) {
+  if (sorted_)
+    record_(mode, trans, target, id, data, indices, insert_restart);
+  else if (mode == DrawMode::tex)
+    push_trans_tex_(target, id, data, indices);
+  else if (trans)
+    push_trans_(mode, data, indices, insert_restart);
+  else
+    push_opaque_(mode, data, indices, insert_restart);
+}
+
+void Batcher::push_opaque_(DrawMode mode, std::span<const float> data, std::span<const unsigned int> indices,
+                           bool insert_restart) {
+  const auto flat = flat_(mode);
+  if (flat)
+    data = flatten_(data, floats_per_vertex_[mode]);
+
   auto it = opaque_batches_.find(mode);
   if (it == opaque_batches_.end()) {
     it = opaque_batches_.emplace_hint(
@@ -191,87 +799,328 @@ void Batcher::add_opaque(const DrawMode& mode, const std::initializer_list<float
       mode,
       BatchList(
         *ctx,
-        *shaders_[mode],
+        flat ? *flat_shaders_[mode] : *shaders_[mode],
         mode,
-        attrib_descs_[mode],
+        flat ? BATCH_FLAT_VERTEX : *layouts_[mode],
         vertices_per_obj_[mode],
-        floats_per_vertex_[mode],
         true
       )
     );
   }
 
   it->second.add(data, indices, insert_restart);
-  z += 1.0f;
 }
 
-void Batcher::add_trans(const DrawMode& mode, std::initializer_list<float> data,
-                        std::initializer_list<unsigned int> indices, bool insert_restart) {
+void Batcher::push_trans_(DrawMode mode, std::span<const float> data, std::span<const unsigned int> indices,
+                          bool insert_restart) {
   if (last_trans_draw_mode_ != DrawMode::none && last_trans_draw_mode_ != mode) {
-    collect_trans_draw_calls_();
+    record_trans_();
   }
   last_trans_draw_mode_ = mode;
 
+  const auto flat = flat_(mode);
+  if (flat)
+    data = flatten_(data, floats_per_vertex_[mode]);
+
   auto it = trans_batches_.find(mode);
-  if (!trans_batches_.contains(mode)) {
+  if (it == trans_batches_.end()) {
     it = trans_batches_.emplace_hint(
       it,
       mode,
       BatchList(
         *ctx,
-        *shaders_[mode],
+        flat ? *flat_shaders_[mode] : *shaders_[mode],
         mode,
-        attrib_descs_[mode],
+        flat ? BATCH_FLAT_VERTEX : *layouts_[mode],
         vertices_per_obj_[mode],
-        floats_per_vertex_[mode],
-        false
+        false,
+        TexTarget::tex_2d,
+        mode == DrawMode::triangles ? &*quad_ebo_ : nullptr
       )
     );
   }
 
   it->second.add(data, indices, insert_restart);
-  z += 1.0f;
-}
-
-void Batcher::add_opaque_tex(GLuint id, std::initializer_list<float> data, std::initializer_list<unsigned> indices) {
-  add_trans_tex(id, data, indices);  // TODO: Specialize so we can take advantage of z ordering here
 }
 
-void Batcher::add_trans_tex(GLuint id, std::initializer_list<float> data, std::initializer_list<unsigned> indices) {
+void Batcher::push_trans_tex_(TexTarget target, GLuint id, std::span<const float> data,
+                              std::span<const unsigned int> indices) {
   if ((last_trans_draw_mode_ != DrawMode::none && last_trans_draw_mode_ != DrawMode::tex) ||
       (last_tex_id_ != 0 && last_tex_id_ != id)) {
-    collect_trans_draw_calls_();
+    record_trans_();
   }
   last_trans_draw_mode_ = DrawMode::tex;
   last_tex_id_ = id;
 
-  while (tex_batches_.size() <= id) {
-    tex_batches_.emplace_back(
-      *ctx,
-      *tex_shader_,
-      DrawMode::triangles,
-      "in_pos:3f in_color:4f in_tex_coords:2f in_trans:3f",
-      4,
-      12,
-      false
+  const auto flat = flat_(DrawMode::tex);
+  if (flat)
+    data = flatten_(data, floats_per_vertex(BATCH_TEX_VERTEX));
+
+  auto it = tex_batches_.find(id);
+  if (it == tex_batches_.end()) {
+    const auto array = target == TexTarget::tex_2d_array;
+    it = tex_batches_.emplace_hint(
+      it,
+      id,
+      BatchList(
+        *ctx,
+        flat ? (array ? *tex_array_flat_shader_ : *tex_flat_shader_) : (array ? *tex_array_shader_ : *tex_shader_),
+        DrawMode::triangles,
+        flat ? BATCH_FLAT_TEX_VERTEX : BATCH_TEX_VERTEX,
+        4,
+        false,
+        target,
+        &*quad_ebo_
+      )
     );
   }
 
-  tex_batches_[id].add_tex(id, data, indices, false);
-  z += 1.0f;
+  it->second.add_tex(id, data, indices, false);
 }
 
-void Batcher::draw(const glm::mat4& projection) {
+bool Batcher::flat_(DrawMode mode) const {
+  return cpu_transform_ && mode != DrawMode::points;
+}
+
+std::span<const float> Batcher::flatten_(std::span<const float> data, std::size_t fpv) {
+  flattener_.flatten(data, fpv, flat_vertices_);
+  return flat_vertices_;
+}
+
+/* Sort key layout
+ *
+ *   opaque:      [63] 0 | [62..32] state         | [31..0] z
+ *   transparent: [63] 1 | [62..31] z             | [30..0] state
+ *
+ * where state is [30..24] shader | [23..8] texture slot | [7..0] draw mode
+ *
+ * Opaque primitives are independent of order thanks to the depth buffer, so they are
+ * grouped by state first. They are fed into the fill_reverse opaque batches in ascending
+ * z order, which leaves the highest z (frontmost) at the start of the buffer
+ */
+void Batcher::record_(DrawMode mode, bool trans, TexTarget target, GLuint id,
+                      std::span<const float> data, std::span<const unsigned int> indices, bool insert_restart) {
+  std::uint32_t shader_slot, mode_slot;
+  switch (mode) {
+    case DrawMode::points: shader_slot = 0; mode_slot = 0; break;
+    case DrawMode::lines: shader_slot = 1; mode_slot = 1; break;
+    case DrawMode::line_loop: shader_slot = 1; mode_slot = 2; break;
+    case DrawMode::triangles: shader_slot = 2; mode_slot = 3; break;
+    case DrawMode::tex: shader_slot = target == TexTarget::tex_2d_array ? 4 : 3; mode_slot = 4; break;
+    default: std::unreachable();
+  }
+
+  std::uint32_t tex_slot = 0;
+  if (mode == DrawMode::tex) {
+    auto it = sort_tex_slots_.find(id);
+    if (it == sort_tex_slots_.end()) {
+      // Slots start over every replay, so this only trips with 65535 textures in one frame
+      assert(sort_tex_slots_.size() < 0xffff && "Out of texture slots in the sort key");
+      it = sort_tex_slots_.emplace_hint(it, id, static_cast<std::uint32_t>(sort_tex_slots_.size() + 1));
+    }
+    tex_slot = it->second;
+  }
+
+  const std::uint32_t state = (shader_slot << 24) | (tex_slot << 8) | mode_slot;
+  const auto z_bits = static_cast<std::uint64_t>(static_cast<std::uint32_t>(z));
+
+  std::uint64_t key;
+  if (trans)
+    key = (1ull << 63) | (z_bits << 31) | state;
+  else
+    key = (static_cast<std::uint64_t>(state) << 32) | z_bits;
+
+  // Conservative screen bounds, including the rotation applied in the vertex shader
+  const auto fpv = mode == DrawMode::tex ? floats_per_vertex(BATCH_TEX_VERTEX) : floats_per_vertex_[mode];
+  glm::vec4 bounds{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                   std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+  for (std::size_t v = 0; v + fpv <= data.size(); v += fpv) {
+    float x = data[v], y = data[v + 1];
+    if (mode != DrawMode::points && data[v + fpv - 1] != 0.0f) {
+      const float cx = data[v + fpv - 3], cy = data[v + fpv - 2];
+      const float c = std::cos(data[v + fpv - 1]), s = std::sin(data[v + fpv - 1]);
+      const float dx = x - cx, dy = y - cy;
+      x = cx + dx * c - dy * s;
+      y = cy + dx * s + dy * c;
+    }
+    bounds.x = std::min(bounds.x, x);
+    bounds.y = std::min(bounds.y, y);
+    bounds.z = std::max(bounds.z, x + 1.0f);
+    bounds.w = std::max(bounds.w, y + 1.0f);
+  }
+
+  sort_items_.emplace_back(
+    key, state, mode, target, id, insert_restart,
+    sort_vertices_.size(), data.size(),
+    sort_indices_.size(), indices.size(),
+    bounds
+  );
+  sort_vertices_.insert(sort_vertices_.end(), data.begin(), data.end());
+  sort_indices_.insert(sort_indices_.end(), indices.begin(), indices.end());
+}
+
+void Batcher::replay_sorted_() {
+  // How many batches back a transparent primitive may look for one with matching state
+  constexpr std::size_t MERGE_LOOKBACK = 16;
+
+  radix_sort(sort_items_, sort_scratch_, [](const SortItem_& i) { return i.key; });
+
+  const auto overlaps = [](const glm::vec4& a, const glm::vec4& b) {
+    return a.x < b.z && b.x < a.z && a.y < b.w && b.y < a.w;
+  };
+
+  const auto push_item = [&](const SortItem_& item) {
+    const auto data = std::span(sort_vertices_).subspan(item.v_first, item.v_count);
+    const auto indices = std::span(sort_indices_).subspan(item.i_first, item.i_count);
+
+    if (item.mode == DrawMode::tex)
+      push_trans_tex_(item.tex_target, item.tex_id, data, indices);
+    else if (item.key >> 63)
+      push_trans_(item.mode, data, indices, item.insert_restart);
+    else
+      push_opaque_(item.mode, data, indices, item.insert_restart);
+  };
+
+  std::size_t i = 0;
+  for (; i < sort_items_.size() && !(sort_items_[i].key >> 63); ++i)
+    push_item(sort_items_[i]);
+
+  std::size_t group_count = 0;
+  for (; i < sort_items_.size(); ++i) {
+    const auto& item = sort_items_[i];
+
+    std::optional<std::size_t> target{};
+    for (std::size_t g = group_count; g > 0 && group_count - g < MERGE_LOOKBACK; --g) {
+      if (sort_groups_[g - 1].state == item.state) {
+        target = g - 1;
+        break;
+      }
+      if (overlaps(sort_groups_[g - 1].bounds, item.bounds))
+        break;
+    }
+
+    if (!target) {
+      if (group_count == sort_groups_.size())
+        sort_groups_.emplace_back();
+      target = group_count++;
+      sort_groups_[*target].state = item.state;
+      sort_groups_[*target].bounds = item.bounds;
+      sort_groups_[*target].items.clear();
+    }
+
+    auto& group = sort_groups_[*target];
+    group.bounds = {
+      std::min(group.bounds.x, item.bounds.x), std::min(group.bounds.y, item.bounds.y),
+      std::max(group.bounds.z, item.bounds.z), std::max(group.bounds.w, item.bounds.w)
+    };
+    group.items.emplace_back(i);
+  }
+
+  for (std::size_t g = 0; g < group_count; ++g)
+    for (const auto idx: sort_groups_[g].items)
+      push_item(sort_items_[idx]);
+
+  sort_items_.clear();
+  sort_vertices_.clear();
+  sort_indices_.clear();
+  sort_tex_slots_.clear();
+}
+
+const RenderCmdBuffer& Batcher::opaque_commands() const {
+  return last_opaque_cmds_;
+}
+
+const RenderCmdBuffer& Batcher::trans_commands() const {
+  return last_trans_cmds_;
+}
+
+const RenderCmdStats& Batcher::command_stats() const {
+  return cmd_stats_;
+}
+
+void Batcher::push_sprite_(GLuint id, const SpriteRecord& s) {
+  if ((last_trans_draw_mode_ != DrawMode::none && last_trans_draw_mode_ != DrawMode::sprite) ||
+      (last_trans_draw_mode_ == DrawMode::sprite && sprite_tex_id_ != id)) {
+    record_trans_();
+  }
+  last_trans_draw_mode_ = DrawMode::sprite;
+  sprite_tex_id_ = id;
+
+  sprites_.emplace_back(s);
+}
+
+void Batcher::record_sprites_(RenderCmdBuffer& cmds) {
+  const auto count = sprites_.size() - sprite_run_start_;
+  if (count == 0)
+    return;
+
+  cmds.bind_program(tex_pulled_shader_->id);
+  cmds.bind_vao(empty_vao_->id);
+  cmds.bind_texture(GL_TEXTURE_2D, sprite_tex_id_);
+  cmds.set_transform(tex_pulled_model_.loc());
+  cmds.draw_arrays(DrawMode::triangles, static_cast<GLsizei>(count * 6), static_cast<GLsizei>(sprite_run_start_ * 6));
+
+  sprite_run_start_ = sprites_.size();
+}
+
+void Batcher::sync_sprites_() {
+  if (sprites_.empty())
+    return;
+
+  const auto size = sprites_.size() * sizeof(SpriteRecord);
+  sprite_ssbo_->bind(BufTarget::shader_storage);
+  if (size > sprite_ssbo_capacity_)
+    sprite_ssbo_capacity_ = std::max(size, sprite_ssbo_capacity_ * 2);
+
+  // Orphaned every frame, so this upload doesn't wait on last frame's draws
+  ctx->gl.BufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(sprite_ssbo_capacity_), nullptr, GL_STREAM_DRAW);
+  ctx->gl.BufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(size), sprites_.data());
+  sprite_ssbo_->unbind(BufTarget::shader_storage);
+
+  ctx->bind_buffer_base(GL_SHADER_STORAGE_BUFFER, 0, sprite_ssbo_->id);
+}
+
+void Batcher::record_opaque_() {
+  // Opaque batches fill in reverse, so walking everything backwards draws front to back
+  std::vector<BatchList*> lists{};
+  for (auto& b: opaque_batches_ | std::views::values)
+    lists.emplace_back(&b);
+  for (auto* b: lists | std::views::reverse)
+    b->record(opaque_cmds_, 0, true);
+}
+
+void Batcher::record_trans_() {
+  if (last_trans_draw_mode_ != DrawMode::none) {
+    if (last_trans_draw_mode_ == DrawMode::tex)
+      tex_batches_.at(last_tex_id_).record(trans_cmds_, last_tex_id_);
+    else if (last_trans_draw_mode_ == DrawMode::sprite)
+      record_sprites_(trans_cmds_);
+    else
+      trans_batches_.at(last_trans_draw_mode_).record(trans_cmds_);
+  }
+}
+
+RenderCmdStats Batcher::execute_(RenderCmdBuffer& opaque, RenderCmdBuffer& trans, const glm::mat4& projection,
+                                 float z_max) {
   ctx->enable(Capability::primitive_restart);
-  ctx->gl.PrimitiveRestartIndex(std::numeric_limits<GLuint>::max());
+  ctx->primitive_restart_index(std::numeric_limits<GLuint>::max());
 
   ctx->enable(Capability::depth_test);
 
-  collect_opaque_draw_calls_();
-  for (const auto& c: opaque_draw_calls_ | std::views::reverse) {
-    c(ctx->gl, projection, z);
+  auto* indirect = multi_draw_ ? &indirect_[storage_set_] : nullptr;
+  if (multi_draw_) {
+    opaque.coalesce();
+    trans.coalesce();
   }
-  clear_opaque_();
+
+  // std140: the mat4 takes the first 16 floats, z_max follows and the block pads out to 20
+  const auto* p = glm::value_ptr(projection);
+  std::copy(p, p + 16, frame_block_.begin());
+  frame_block_[16] = z_max;
+  frame_ubo_->write_sub(0, frame_block_);
+  ctx->bind_buffer_base(GL_UNIFORM_BUFFER, BATCH_FRAME_BINDING, frame_ubo_->id);
+
+  auto stats = opaque.execute(*ctx, z_max, indirect);
 
   ctx->blend_func_separate(
     BlendFunc::one, BlendFunc::one_minus_src_alpha,
@@ -279,47 +1128,50 @@ void Batcher::draw(const glm::mat4& projection) {
   ctx->enable(Capability::blend);
   ctx->depth_mask(false);
 
-  collect_trans_draw_calls_();
-  for (const auto& c: trans_draw_calls_) {
-    c(ctx->gl, projection, z);
-  }
-  clear_trans_();
+  const auto trans_stats = trans.execute(*ctx, z_max, indirect);
+  stats.issued += trans_stats.issued;
+  stats.elided += trans_stats.elided;
+  stats.draws += trans_stats.draws;
+  stats.ranges += trans_stats.ranges;
 
   ctx->depth_mask(true);
   ctx->disable(Capability::blend);
 
   ctx->disable(Capability::depth_test);
 
-  z = 1.0f;
+  return stats;
 }
 
-void Batcher::collect_opaque_draw_calls_() {
-  for (auto& b: opaque_batches_ | std::views::values) {
-    auto draw_calls = b.get_draw_calls();
-    opaque_draw_calls_.insert(opaque_draw_calls_.end(), draw_calls.begin(), draw_calls.end());
-  }
-}
-
-void Batcher::collect_trans_draw_calls_() {
-  if (last_trans_draw_mode_ != DrawMode::none) {
-    std::vector<DrawCall> draw_calls;
-    if (last_trans_draw_mode_ == DrawMode::tex)
-      draw_calls = tex_batches_.at(last_tex_id_).get_draw_calls_tex(last_tex_id_);
-    else
-      draw_calls = trans_batches_.at(last_trans_draw_mode_).get_draw_calls();
-    trans_draw_calls_.insert(trans_draw_calls_.end(), draw_calls.begin(), draw_calls.end());
-  }
+void Batcher::sync_() {
+  std::ranges::for_each(opaque_batches_ | std::views::values, [](auto& b) { b.sync(); });
+  std::ranges::for_each(trans_batches_ | std::views::values, [](auto& b) { b.sync(); });
+  std::ranges::for_each(tex_batches_ | std::views::values, [](auto& b) { b.sync(); });
 }
 
 void Batcher::clear_opaque_() {
   std::ranges::for_each(opaque_batches_ | std::views::values, [](auto& b) { b.clear(); });
-  opaque_draw_calls_.clear();
+  std::swap(opaque_cmds_, last_opaque_cmds_);
+  opaque_cmds_.clear();
 }
 
 void Batcher::clear_trans_() {
   std::ranges::for_each(trans_batches_ | std::views::values, [](auto& b) { b.clear(); });
-  std::ranges::for_each(tex_batches_, [](auto& b) { b.clear(); });
-  trans_draw_calls_.clear();
+  std::ranges::for_each(tex_batches_ | std::views::values, [](auto& b) { b.clear(); });
+  std::swap(trans_cmds_, last_trans_cmds_);
+  trans_cmds_.clear();
   last_trans_draw_mode_ = DrawMode::none;
+
+  sprites_.clear();
+  sprite_run_start_ = 0;
+}
+
+void Batcher::r_end_frame_(const E_EndFrame& p) {
+  std::ranges::for_each(opaque_batches_ | std::views::values, [&](auto& b) { batches_released_ += b.swap(); });
+  std::ranges::for_each(trans_batches_ | std::views::values, [&](auto& b) { batches_released_ += b.swap(); });
+  std::ranges::for_each(tex_batches_ | std::views::values, [&](auto& b) { batches_released_ += b.swap(); });
+  storage_set_ = (storage_set_ + 1) % BATCH_STORAGE_SETS;
+
+  // Every execute this frame appended to it, the GPU is done with it by the time it comes around
+  indirect_[storage_set_].clear();
 }
 } // namespace imp
@@ -1,6 +1,57 @@
 #include "imp/gfx/module/2d/gfx_2d.hpp"
 
+#include "imgui.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
 namespace imp {
+namespace {
+// Segment counts available for circles, each one is a unit mesh built on first use
+constexpr std::array<std::size_t, 6> CIRCLE_LODS = {8, 16, 32, 64, 128, 256};
+
+// Largest distance allowed between a true circle and its polygon, in pixels
+constexpr float CIRCLE_MAX_ERROR = 0.25f;
+
+struct UnitCircle {
+  std::vector<float> x{};
+  std::vector<float> y{};
+  std::vector<unsigned int> fill{};    // fan around a center vertex at index 0, the ring starts at 1
+  std::vector<unsigned int> outline{}; // ring only
+};
+
+const UnitCircle& unit_circle(std::size_t lod) {
+  static const auto circles = [] {
+    std::array<UnitCircle, CIRCLE_LODS.size()> cs{};
+    for (std::size_t l = 0; l < CIRCLE_LODS.size(); ++l) {
+      const auto n = static_cast<unsigned int>(CIRCLE_LODS[l]);
+      for (unsigned int i = 0; i < n; ++i) {
+        const auto a = 2.0 * std::numbers::pi * i / n;
+        cs[l].x.emplace_back(static_cast<float>(std::cos(a)));
+        cs[l].y.emplace_back(static_cast<float>(std::sin(a)));
+        cs[l].outline.emplace_back(i);
+        cs[l].fill.insert(cs[l].fill.end(), {0u, i + 1, (i + 1) % n + 1});
+      }
+    }
+    return cs;
+  }();
+  return circles[lod];
+}
+
+// Shapes may be drawn from BatchRecorder threads, so their scratch space is per thread
+thread_local std::vector<float> shape_vertices{};
+thread_local std::vector<unsigned int> shape_indices{};
+thread_local std::vector<float> poly_px{}, poly_py{}, poly_nx{}, poly_ny{};
+
+constexpr std::size_t SHAPE_FLOATS_PER_VERTEX = 10;
+
+void push_vertex(std::vector<float>& v, float x, float y, float z, const glm::vec4& c, glm::vec2 rcenter, float angle) {
+  v.insert(v.end(), {x, y, z, c.r, c.g, c.b, c.a, rcenter.x, rcenter.y, angle});
+}
+} // namespace
+
 std::once_flag Gfx2D::created_required_modules_;
 
 Gfx2D::Gfx2D(const std::weak_ptr<ModuleMgr>& module_mgr): Module(module_mgr) {
@@ -10,7 +61,25 @@ Gfx2D::Gfx2D(const std::weak_ptr<ModuleMgr>& module_mgr): Module(module_mgr) {
 
   batcher = module_mgr.lock()->get<Batcher>();
   ctx = module_mgr.lock()->get<GfxContext>();
+  fonts = module_mgr.lock()->get<FontMgr>();
   textures = module_mgr.lock()->get<TextureMgr>();
+
+  update_cull_rect_();
+
+  ctx->debug_overlay->add_tab(module_name, [&] {
+    ImGui::Separator();
+
+    if (bool v = is_culling(); ImGui::Checkbox("Cull", &v)) {
+      set_culling(v);
+    }
+    if (is_culling()) {
+      ImGui::Text("Submitted: %zu", last_submitted_);
+      ImGui::Text("Culled: %zu", last_culled_);
+    } else
+      ImGui::TextDisabled("Primitives are only counted while culling");
+  });
+
+  IMP_HERMES_SUB(E_StartFrame, module_name, r_start_frame_);
 }
 
 void Gfx2D::clear(const Color& color, const ClearBit& mask) {
@@ -19,9 +88,56 @@ void Gfx2D::clear(const Color& color, const ClearBit& mask) {
   ctx->gl.Clear(unwrap(mask));
 }
 
+void Gfx2D::set_culling(bool enabled) {
+  culling_ = enabled;
+}
+
+bool Gfx2D::is_culling() const {
+  return culling_;
+}
+
+void Gfx2D::set_cull_projection(const glm::mat4& projection) {
+  cull_projection_ = projection;
+  update_cull_rect_();
+}
+
+void Gfx2D::reset_cull_projection() {
+  cull_projection_.reset();
+  update_cull_rect_();
+}
+
+std::optional<glm::mat4> Gfx2D::cull_projection() const {
+  return cull_projection_;
+}
+
+glm::vec4 Gfx2D::cull_rect() const {
+  return cull_rect_;
+}
+
+std::size_t Gfx2D::cull_boxes(
+  std::span<const float> min_x, std::span<const float> min_y,
+  std::span<const float> max_x, std::span<const float> max_y,
+  std::span<std::uint8_t> visible
+) const {
+  const auto n = std::min({min_x.size(), min_y.size(), max_x.size(), max_y.size(), visible.size()});
+  const float rx0 = cull_rect_.x, ry0 = cull_rect_.y, rx1 = cull_rect_.z, ry1 = cull_rect_.w;
+
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    const bool v = (min_x[i] <= rx1) & (max_x[i] >= rx0) & (min_y[i] <= ry1) & (max_y[i] >= ry0);
+    visible[i] = static_cast<std::uint8_t>(v);
+    count += v;
+  }
+  return count;
+}
+
 void Gfx2D::point(glm::vec2 xy, const Color& c) {
+  if (!visible_({xy}, {0, 0}, 0))
+    return;
+
   const auto gl_c = c.gl_color();
-  const std::initializer_list<float> vdata = {xy.x, xy.y, batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a};
+  const auto z = batcher->current_z();
+  const std::initializer_list<float> vdata = {xy.x, xy.y, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a};
   const std::initializer_list<unsigned int> idata = {0};
 
   if (gl_c.a < 1.0) {
@@ -32,10 +148,14 @@ void Gfx2D::point(glm::vec2 xy, const Color& c) {
 }
 
 void Gfx2D::line(const glm::vec2 p0, const glm::vec2 p1, const glm::vec2 rcenter, const float angle, const Color& c) {
+  if (!visible_({p0, p1}, rcenter, angle))
+    return;
+
   const auto gl_c = c.gl_color();
+  const auto z = batcher->current_z();
   const std::initializer_list<float> vdata = {
-    p0.x, p0.y, batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
-    p1.x, p1.y, batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
+    p0.x, p0.y, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
+    p1.x, p1.y, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
   };
   const std::initializer_list<unsigned int> idata = {0, 1};
 
@@ -56,11 +176,15 @@ void Gfx2D::line(const glm::vec2 p0, const glm::vec2 p1, const Color& c) {
 }
 
 void Gfx2D::draw_tri(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, glm::vec2 rcenter, float angle, const Color& c) {
+  if (!visible_({p0, p1, p2}, rcenter, angle))
+    return;
+
   const auto gl_c = c.gl_color();
+  const auto z = batcher->current_z();
   const std::initializer_list<float> vdata = {
-    p0.x, p0.y, batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
-    p1.x, p1.y, batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
-    p2.x, p2.y, batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
+    p0.x, p0.y, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
+    p1.x, p1.y, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
+    p2.x, p2.y, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
   };
   const std::initializer_list<unsigned int> idata = {0, 1, 2};
 
@@ -82,11 +206,15 @@ void Gfx2D::draw_tri(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, const Color& c) {
 
 void Gfx2D::fill_tri(const glm::vec2 p0, const glm::vec2 p1, const glm::vec2 p2, const glm::vec2 rcenter, float angle,
                      const Color& c) {
+  if (!visible_({p0, p1, p2}, rcenter, angle))
+    return;
+
   const auto gl_c = c.gl_color();
+  const auto z = batcher->current_z();
   const std::initializer_list<float> vdata = {
-    p0.x, p0.y, batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
-    p1.x, p1.y, batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
-    p2.x, p2.y, batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
+    p0.x, p0.y, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
+    p1.x, p1.y, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
+    p2.x, p2.y, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
   };
   const std::initializer_list<unsigned int> idata = {0, 1, 2};
 
@@ -107,12 +235,16 @@ void Gfx2D::fill_tri(const glm::vec2 p0, const glm::vec2 p1, const glm::vec2 p2,
 }
 
 void Gfx2D::draw_rect(glm::vec2 xy, glm::vec2 size, glm::vec2 rcenter, float angle, const Color& c) {
+  if (!visible_rect_(xy, size, rcenter, angle))
+    return;
+
   const auto gl_c = c.gl_color();
+  const auto z = batcher->current_z();
   const std::initializer_list<float> vdata = {
-    xy.x,          xy.y,          batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
-    xy.x + size.x, xy.y,          batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
-    xy.x + size.x, xy.y + size.y, batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
-    xy.x,          xy.y + size.y, batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
+    xy.x,          xy.y,          z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
+    xy.x + size.x, xy.y,          z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
+    xy.x + size.x, xy.y + size.y, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
+    xy.x,          xy.y + size.y, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
   };
   const std::initializer_list<unsigned int> idata = {0, 1, 2, 3};
 
@@ -133,12 +265,20 @@ void Gfx2D::draw_rect(glm::vec2 xy, glm::vec2 size, const Color& c) {
 }
 
 void Gfx2D::fill_rect(const glm::vec2 xy, const glm::vec2 size, const glm::vec2 rcenter, float angle, const Color& c) {
+  if (!visible_rect_(xy, size, rcenter, angle))
+    return;
+
+  fill_rect_(xy, size, rcenter, angle, c);
+}
+
+void Gfx2D::fill_rect_(const glm::vec2 xy, const glm::vec2 size, const glm::vec2 rcenter, float angle, const Color& c) {
   const auto gl_c = c.gl_color();
+  const auto z = batcher->current_z();
   const std::initializer_list<float> vdata = {
-    xy.x,          xy.y,          batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
-    xy.x + size.x, xy.y,          batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
-    xy.x + size.x, xy.y + size.y, batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
-    xy.x,          xy.y + size.y, batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
+    xy.x,          xy.y,          z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
+    xy.x + size.x, xy.y,          z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
+    xy.x + size.x, xy.y + size.y, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
+    xy.x,          xy.y + size.y, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, rcenter.x, rcenter.y, glm::radians(angle),
   };
   const std::initializer_list<unsigned int> idata = {0, 1, 2, 0, 2, 3};
 
@@ -158,20 +298,351 @@ void Gfx2D::fill_rect(const glm::vec2 xy, const glm::vec2 size, const Color& c)
   fill_rect(xy, size, {0, 0}, 0, c);
 }
 
+void Gfx2D::fill_rect(std::span<const glm::vec2> xy, std::span<const glm::vec2> size, const Color& c) {
+  const auto n = std::min(xy.size(), size.size());
+  if (!culling_active_()) {
+    for (std::size_t i = 0; i < n; ++i)
+      fill_rect_(xy[i], size[i], {0, 0}, 0, c);
+    return;
+  }
+
+  bulk_bounds_.resize(n * 4);
+  bulk_visible_.resize(n);
+  const auto min_x = std::span(bulk_bounds_).subspan(0, n), min_y = std::span(bulk_bounds_).subspan(n, n);
+  const auto max_x = std::span(bulk_bounds_).subspan(n * 2, n), max_y = std::span(bulk_bounds_).subspan(n * 3, n);
+  for (std::size_t i = 0; i < n; ++i) {
+    min_x[i] = std::min(xy[i].x, xy[i].x + size[i].x);
+    min_y[i] = std::min(xy[i].y, xy[i].y + size[i].y);
+    max_x[i] = std::max(xy[i].x, xy[i].x + size[i].x);
+    max_y[i] = std::max(xy[i].y, xy[i].y + size[i].y);
+  }
+
+  const auto visible = cull_boxes(min_x, min_y, max_x, max_y, bulk_visible_);
+  for (std::size_t i = 0; i < n; ++i)
+    if (bulk_visible_[i])
+      fill_rect_(xy[i], size[i], {0, 0}, 0, c);
+  count_(visible, n - visible);
+}
+
+void Gfx2D::draw_circle(glm::vec2 center, float radius, const Color& c) {
+  if (!visible_({center - radius, center + radius}, {0, 0}, 0))
+    return;
+
+  const auto& uc = unit_circle(circle_lod_(radius));
+  const auto gl_c = c.gl_color();
+  const auto z = batcher->current_z();
+
+  auto& v = shape_vertices;
+  v.clear();
+  for (std::size_t i = 0; i < uc.x.size(); ++i)
+    push_vertex(v, center.x + radius * uc.x[i], center.y + radius * uc.y[i], z, gl_c, {0, 0}, 0);
+
+  shape_(gl_c.a < 1.0, DrawMode::line_loop, v, uc.outline, true);
+}
+
+void Gfx2D::fill_circle(glm::vec2 center, float radius, const Color& c) {
+  if (!visible_({center - radius, center + radius}, {0, 0}, 0))
+    return;
+
+  const auto& uc = unit_circle(circle_lod_(radius));
+  const auto gl_c = c.gl_color();
+  const auto z = batcher->current_z();
+
+  auto& v = shape_vertices;
+  v.clear();
+  push_vertex(v, center.x, center.y, z, gl_c, {0, 0}, 0);
+  for (std::size_t i = 0; i < uc.x.size(); ++i)
+    push_vertex(v, center.x + radius * uc.x[i], center.y + radius * uc.y[i], z, gl_c, {0, 0}, 0);
+
+  shape_(gl_c.a < 1.0, DrawMode::triangles, v, uc.fill);
+}
+
+void Gfx2D::arc(glm::vec2 center, float radius, float start, float end, const Color& c) {
+  const auto sweep = glm::radians(end - start);
+  if (sweep == 0.0f || !visible_({center - radius, center + radius}, {0, 0}, 0))
+    return;
+
+  const auto full = static_cast<float>(CIRCLE_LODS[circle_lod_(radius)]);
+  const auto n = std::max(1, static_cast<int>(std::ceil(full * std::abs(sweep) / (2.0f * std::numbers::pi_v<float>))));
+  const auto gl_c = c.gl_color();
+  const auto z = batcher->current_z();
+
+  // Step around by rotating the previous point, so there's only one sin/cos pair per arc
+  const auto cs = std::cos(sweep / n), sn = std::sin(sweep / n);
+  float ux = std::cos(glm::radians(start)), uy = std::sin(glm::radians(start));
+
+  auto& v = shape_vertices;
+  auto& idx = shape_indices;
+  v.clear();
+  idx.clear();
+  for (int i = 0; i <= n; ++i) {
+    push_vertex(v, center.x + radius * ux, center.y + radius * uy, z, gl_c, {0, 0}, 0);
+    if (i < n)
+      idx.insert(idx.end(), {static_cast<unsigned int>(i), static_cast<unsigned int>(i + 1)});
+
+    const auto rx = ux * cs - uy * sn;
+    uy = ux * sn + uy * cs;
+    ux = rx;
+  }
+
+  shape_(gl_c.a < 1.0, DrawMode::lines, v, idx);
+}
+
+void Gfx2D::fill_rounded_rect(glm::vec2 xy, glm::vec2 size, float radius, glm::vec2 rcenter, float angle, const Color& c) {
+  if (!visible_rect_(xy, size, rcenter, angle))
+    return;
+
+  const auto r = std::clamp(radius, 0.0f, std::min(std::abs(size.x), std::abs(size.y)) / 2.0f);
+  if (r == 0.0f) {
+    fill_rect_(xy, size, rcenter, angle, c);
+    return;
+  }
+
+  const auto& uc = unit_circle(circle_lod_(r));
+  const auto n = uc.x.size();
+  const auto q = n / 4;
+  const auto gl_c = c.gl_color();
+  const auto z = batcher->current_z();
+  const auto a = glm::radians(angle);
+
+  // Each corner takes a quarter of the unit circle, walking clockwise from the bottom right
+  const std::array<glm::vec2, 4> corners = {{
+    {xy.x + size.x - r, xy.y + size.y - r},
+    {xy.x + r, xy.y + size.y - r},
+    {xy.x + r, xy.y + r},
+    {xy.x + size.x - r, xy.y + r},
+  }};
+
+  auto& v = shape_vertices;
+  auto& idx = shape_indices;
+  v.clear();
+  idx.clear();
+  push_vertex(v, xy.x + size.x / 2.0f, xy.y + size.y / 2.0f, z, gl_c, rcenter, a);
+  for (std::size_t k = 0; k < 4; ++k) {
+    for (std::size_t j = 0; j <= q; ++j) {
+      const auto i = (k * q + j) % n;
+      push_vertex(v, corners[k].x + r * uc.x[i], corners[k].y + r * uc.y[i], z, gl_c, rcenter, a);
+    }
+  }
+
+  const auto ring = static_cast<unsigned int>(4 * (q + 1));
+  for (unsigned int i = 0; i < ring; ++i)
+    idx.insert(idx.end(), {0u, i + 1, (i + 1) % ring + 1});
+
+  shape_(gl_c.a < 1.0, DrawMode::triangles, v, idx);
+}
+
+void Gfx2D::fill_rounded_rect(glm::vec2 xy, glm::vec2 size, float radius, float angle, const Color& c) {
+  const glm::vec2 center = {xy.x + size.x / 2.0f, xy.y + size.y / 2.0f};
+  fill_rounded_rect(xy, size, radius, center, angle, c);
+}
+
+void Gfx2D::fill_rounded_rect(glm::vec2 xy, glm::vec2 size, float radius, const Color& c) {
+  fill_rounded_rect(xy, size, radius, {0, 0}, 0, c);
+}
+
+void Gfx2D::polyline(std::span<const glm::vec2> points, float thickness, LineJoin join, LineCap cap, const Color& c) {
+  const auto n = points.size();
+  if (n < 2 || thickness <= 0.0f)
+    return;
+
+  const auto m = n - 1;
+  const auto hw = thickness / 2.0f;
+
+  auto& px = poly_px;
+  auto& py = poly_py;
+  auto& nx = poly_nx;
+  auto& ny = poly_ny;
+  px.resize(n);
+  py.resize(n);
+  nx.resize(m);
+  ny.resize(m);
+
+  for (std::size_t i = 0; i < n; ++i) {
+    px[i] = points[i].x;
+    py[i] = points[i].y;
+  }
+
+  float x0 = px[0], y0 = py[0], x1 = px[0], y1 = py[0];
+  for (std::size_t i = 0; i < n; ++i) {
+    x0 = std::min(x0, px[i]);
+    y0 = std::min(y0, py[i]);
+    x1 = std::max(x1, px[i]);
+    y1 = std::max(y1, py[i]);
+  }
+  const auto pad = hw * std::max(join == LineJoin::miter ? MITER_LIMIT : 1.0f,
+                                 cap == LineCap::square ? std::numbers::sqrt2_v<float> : 1.0f);
+  if (!visible_({{x0 - pad, y0 - pad}, {x1 + pad, y1 + pad}}, {0, 0}, 0))
+    return;
+
+  // Offset from each segment's centerline to its left edge, half the thickness long
+  // Kept as its own branchless pass over plain arrays, the joins need every offset anyway
+  for (std::size_t i = 0; i < m; ++i) {
+    const auto dx = px[i + 1] - px[i], dy = py[i + 1] - py[i];
+    const auto k = hw / std::max(std::sqrt(dx * dx + dy * dy), 1e-6f);
+    nx[i] = -dy * k;
+    ny[i] = dx * k;
+  }
+
+  // The direction scaled to the half width is (ny, -nx)
+  if (cap == LineCap::square) {
+    px[0] -= ny[0];
+    py[0] += nx[0];
+    px[m] += ny[m - 1];
+    py[m] -= nx[m - 1];
+  }
+
+  const auto gl_c = c.gl_color();
+  const auto z = batcher->current_z();
+
+  auto& v = shape_vertices;
+  auto& idx = shape_indices;
+
+  // One quad per segment, written straight into place
+  v.resize(m * 4 * SHAPE_FLOATS_PER_VERTEX);
+  idx.resize(m * 6);
+  for (std::size_t i = 0; i < m; ++i) {
+    const std::array<glm::vec2, 4> quad = {{
+      {px[i] + nx[i], py[i] + ny[i]},
+      {px[i] - nx[i], py[i] - ny[i]},
+      {px[i + 1] - nx[i], py[i + 1] - ny[i]},
+      {px[i + 1] + nx[i], py[i + 1] + ny[i]},
+    }};
+    for (std::size_t j = 0; j < 4; ++j) {
+      auto* out = &v[(i * 4 + j) * SHAPE_FLOATS_PER_VERTEX];
+      out[0] = quad[j].x;
+      out[1] = quad[j].y;
+      out[2] = z;
+      out[3] = gl_c.r;
+      out[4] = gl_c.g;
+      out[5] = gl_c.b;
+      out[6] = gl_c.a;
+      out[7] = 0.0f;
+      out[8] = 0.0f;
+      out[9] = 0.0f;
+    }
+
+    const auto b = static_cast<unsigned int>(i * 4);
+    auto* out = &idx[i * 6];
+    out[0] = b;
+    out[1] = b + 1;
+    out[2] = b + 2;
+    out[3] = b;
+    out[4] = b + 2;
+    out[5] = b + 3;
+  }
+
+  const auto vert = [&](float x, float y) {
+    push_vertex(v, x, y, z, gl_c, {0, 0}, 0);
+    return static_cast<unsigned int>(v.size() / SHAPE_FLOATS_PER_VERTEX - 1);
+  };
+
+  // Fan around (cx, cy), starting at offset (ox, oy) and turning by theta radians
+  const auto segments = static_cast<float>(CIRCLE_LODS[circle_lod_(hw)]);
+  const auto fan = [&](float cx, float cy, float ox, float oy, float theta) {
+    const auto k = std::max(1, static_cast<int>(std::ceil(segments * std::abs(theta) / (2.0f * std::numbers::pi_v<float>))));
+    const auto cs = std::cos(theta / k), sn = std::sin(theta / k);
+    const auto center = vert(cx, cy);
+    auto prev = vert(cx + ox, cy + oy);
+    for (int j = 0; j < k; ++j) {
+      const auto rx = ox * cs - oy * sn;
+      oy = ox * sn + oy * cs;
+      ox = rx;
+      const auto curr = vert(cx + ox, cy + oy);
+      idx.insert(idx.end(), {center, prev, curr});
+      prev = curr;
+    }
+  };
+
+  // Joins only fill the wedge on the outside of each turn
+  for (std::size_t j = 1; j < m; ++j) {
+    const auto cross = nx[j - 1] * ny[j] - ny[j - 1] * nx[j];
+    if (std::abs(cross) < 1e-6f * hw * hw)
+      continue;
+
+    const auto s = cross > 0.0f ? -1.0f : 1.0f;
+    const glm::vec2 p = {px[j], py[j]};
+    const glm::vec2 a = {s * nx[j - 1], s * ny[j - 1]};
+    const glm::vec2 b = {s * nx[j], s * ny[j]};
+
+    if (join == LineJoin::round) {
+      fan(p.x, p.y, a.x, a.y, std::atan2(cross, glm::dot(a, b)));
+      continue;
+    }
+
+    if (join == LineJoin::miter) {
+      const auto t = glm::normalize(a + b);
+      const auto cos_half = glm::dot(t, a) / hw;
+      if (cos_half * MITER_LIMIT >= 1.0f) {
+        const auto tip = p + t * (hw / cos_half);
+        const auto c0 = vert(p.x, p.y), c1 = vert(p.x + a.x, p.y + a.y);
+        const auto c2 = vert(tip.x, tip.y), c3 = vert(p.x + b.x, p.y + b.y);
+        idx.insert(idx.end(), {c0, c1, c2, c0, c2, c3});
+        continue;
+      }
+    }
+
+    const auto c0 = vert(p.x, p.y), c1 = vert(p.x + a.x, p.y + a.y), c2 = vert(p.x + b.x, p.y + b.y);
+    idx.insert(idx.end(), {c0, c1, c2});
+  }
+
+  if (cap == LineCap::round) {
+    fan(px[0], py[0], nx[0], ny[0], std::numbers::pi_v<float>);
+    fan(px[m], py[m], -nx[m - 1], -ny[m - 1], std::numbers::pi_v<float>);
+  }
+
+  shape_(gl_c.a < 1.0, DrawMode::triangles, v, idx);
+}
+
+std::size_t Gfx2D::circle_lod_(float radius) const {
+  const auto r = std::abs(radius) * px_per_unit_;
+  if (r <= CIRCLE_MAX_ERROR)
+    return 0;
+
+  // A polygon with n sides is at most r * (1 - cos(pi / n)) away from the circle
+  const auto n = std::numbers::pi_v<float> / std::acos(1.0f - CIRCLE_MAX_ERROR / r);
+  for (std::size_t l = 0; l < CIRCLE_LODS.size(); ++l)
+    if (static_cast<float>(CIRCLE_LODS[l]) >= n)
+      return l;
+  return CIRCLE_LODS.size() - 1;
+}
+
+void Gfx2D::shape_(bool trans, DrawMode mode, std::span<const float> vertices, std::span<const unsigned int> indices,
+                   bool insert_restart) {
+  if (trans) {
+    batcher->add_trans(mode, vertices, indices, insert_restart);
+  } else {
+    batcher->add_opaque(mode, vertices, indices, insert_restart);
+  }
+}
+
 void Gfx2D::draw_tex(const Texture& t, glm::vec2 xy, glm::vec2 rcenter, float angle, const Color& c) {
+  if (!visible_rect_(xy, glm::vec2(t.w(), t.h()), rcenter, angle))
+    return;
+
+  draw_tex_(t, xy, rcenter, angle, c);
+}
+
+void Gfx2D::draw_tex_(const Texture& t, glm::vec2 xy, glm::vec2 rcenter, float angle, const Color& c) {
   const auto gl_c = c.gl_color();
+  if (t.target() == TexTarget::tex_2d &&
+      batcher->add_sprite(t.id(), {xy.x, xy.y, t.w(), t.h()}, rcenter, glm::radians(angle), gl_c))
+    return;
+
+  const auto z = batcher->current_z();
+  const auto l = static_cast<float>(t.layer());
   const std::initializer_list<float> vdata = {
-    xy.x,         xy.y,         batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, 0.0f, 0.0f, rcenter.x, rcenter.y, glm::radians(angle),
-    xy.x + t.w(), xy.y,         batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, 1.0f, 0.0f, rcenter.x, rcenter.y, glm::radians(angle),
-    xy.x + t.w(), xy.y + t.h(), batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, 1.0f, 1.0f, rcenter.x, rcenter.y, glm::radians(angle),
-    xy.x,         xy.y + t.h(), batcher->z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, 0.0f, 1.0f, rcenter.x, rcenter.y, glm::radians(angle),
+    xy.x,         xy.y,         z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, 0.0f, 0.0f, l, rcenter.x, rcenter.y, glm::radians(angle),
+    xy.x + t.w(), xy.y,         z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, 1.0f, 0.0f, l, rcenter.x, rcenter.y, glm::radians(angle),
+    xy.x + t.w(), xy.y + t.h(), z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, 1.0f, 1.0f, l, rcenter.x, rcenter.y, glm::radians(angle),
+    xy.x,         xy.y + t.h(), z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, 0.0f, 1.0f, l, rcenter.x, rcenter.y, glm::radians(angle),
   };
   const std::initializer_list<unsigned int> idata = {0, 1, 2, 0, 2, 3};
 
   if (!t.fully_opaque() || gl_c.a < 1.0) {
-    batcher->add_trans_tex(t.id(), vdata, idata);
+    batcher->add_trans_tex(t.target(), t.id(), vdata, idata);
   } else {
-    batcher->add_opaque_tex(t.id(), vdata, idata);
+    batcher->add_opaque_tex(t.target(), t.id(), vdata, idata);
   }
 }
 
@@ -183,4 +654,142 @@ void Gfx2D::draw_tex(const Texture& t, glm::vec2 xy, float angle, const Color& c
 void Gfx2D::draw_tex(const Texture& t, glm::vec2 xy, const Color& c) {
   draw_tex(t, xy, {0, 0}, 0, c);
 }
+
+void Gfx2D::draw_tex(const Texture& t, std::span<const glm::vec2> xy, const Color& c) {
+  const auto n = xy.size();
+  if (!culling_active_()) {
+    for (const auto& p: xy)
+      draw_tex_(t, p, {0, 0}, 0, c);
+    return;
+  }
+
+  bulk_bounds_.resize(n * 4);
+  bulk_visible_.resize(n);
+  const auto min_x = std::span(bulk_bounds_).subspan(0, n), min_y = std::span(bulk_bounds_).subspan(n, n);
+  const auto max_x = std::span(bulk_bounds_).subspan(n * 2, n), max_y = std::span(bulk_bounds_).subspan(n * 3, n);
+  const auto w = static_cast<float>(t.w()), h = static_cast<float>(t.h());
+  for (std::size_t i = 0; i < n; ++i) {
+    min_x[i] = xy[i].x;
+    min_y[i] = xy[i].y;
+    max_x[i] = xy[i].x + w;
+    max_y[i] = xy[i].y + h;
+  }
+
+  const auto visible = cull_boxes(min_x, min_y, max_x, max_y, bulk_visible_);
+  for (std::size_t i = 0; i < n; ++i)
+    if (bulk_visible_[i])
+      draw_tex_(t, xy[i], {0, 0}, 0, c);
+  count_(visible, n - visible);
+}
+
+void Gfx2D::text(const Font& f, std::string_view s, glm::vec2 xy, float size, glm::vec2 rcenter, float angle, const Color& c) {
+  text_(fonts->shape(f, s, size), xy, rcenter, angle, c);
+}
+
+void Gfx2D::text(const Font& f, std::string_view s, glm::vec2 xy, float size, float angle, const Color& c) {
+  const auto& run = fonts->shape(f, s, size);
+  text_(run, xy, xy + run.size / 2.0f, angle, c);
+}
+
+void Gfx2D::text(const Font& f, std::string_view s, glm::vec2 xy, float size, const Color& c) {
+  text(f, s, xy, size, {0, 0}, 0, c);
+}
+
+void Gfx2D::text_(const TextRun& run, glm::vec2 xy, glm::vec2 rcenter, float angle, const Color& c) {
+  if (run.quads.empty() || !visible_rect_(xy, run.size, rcenter, angle))
+    return;
+
+  const auto gl_c = c.gl_color();
+  const auto id = fonts->atlas_id();
+  for (const auto& q: run.quads) {
+    const auto p0 = xy + glm::vec2(q.pos.x, q.pos.y), p1 = xy + glm::vec2(q.pos.z, q.pos.w);
+    const auto z = batcher->current_z();
+
+    // A negative layer selects the SDF path in the textures shader
+    const std::initializer_list<float> vdata = {
+      p0.x, p0.y, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, q.uv.x, q.uv.y, -1.0f, rcenter.x, rcenter.y, glm::radians(angle),
+      p1.x, p0.y, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, q.uv.z, q.uv.y, -1.0f, rcenter.x, rcenter.y, glm::radians(angle),
+      p1.x, p1.y, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, q.uv.z, q.uv.w, -1.0f, rcenter.x, rcenter.y, glm::radians(angle),
+      p0.x, p1.y, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, q.uv.x, q.uv.w, -1.0f, rcenter.x, rcenter.y, glm::radians(angle),
+    };
+    const std::initializer_list<unsigned int> idata = {0, 1, 2, 0, 2, 3};
+
+    batcher->add_trans_tex(TexTarget::tex_2d, id, vdata, idata);
+  }
+}
+
+void Gfx2D::update_cull_rect_() {
+  const auto inv = glm::inverse(cull_projection_.value_or(ctx->window->projection_matrix()));
+
+  cull_rect_ = {
+    std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+    std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()
+  };
+  for (const auto& ndc: {glm::vec4(-1, -1, 0, 1), glm::vec4(1, -1, 0, 1), glm::vec4(1, 1, 0, 1), glm::vec4(-1, 1, 0, 1)}) {
+    const auto p = inv * ndc;
+    cull_rect_.x = std::min(cull_rect_.x, p.x / p.w);
+    cull_rect_.y = std::min(cull_rect_.y, p.y / p.w);
+    cull_rect_.z = std::max(cull_rect_.z, p.x / p.w);
+    cull_rect_.w = std::max(cull_rect_.w, p.y / p.w);
+  }
+
+  const auto width = cull_rect_.z - cull_rect_.x;
+  px_per_unit_ = width > 0.0f ? static_cast<float>(ctx->window->w()) / width : 1.0f;
+}
+
+bool Gfx2D::culling_active_() const {
+  return culling_ && !BatchRecorder::retaining();
+}
+
+bool Gfx2D::visible_(std::initializer_list<glm::vec2> points, glm::vec2 rcenter, float angle) {
+  if (!culling_active_())
+    return true;
+
+  glm::vec4 b;
+  if (angle == 0.0f) {
+    b = {points.begin()->x, points.begin()->y, points.begin()->x, points.begin()->y};
+    for (const auto& p: points) {
+      b.x = std::min(b.x, p.x);
+      b.y = std::min(b.y, p.y);
+      b.z = std::max(b.z, p.x);
+      b.w = std::max(b.w, p.y);
+    }
+  } else {
+    // Whatever the angle, every point stays within this distance of rcenter
+    float r2 = 0.0f;
+    for (const auto& p: points) {
+      const auto d = p - rcenter;
+      r2 = std::max(r2, d.x * d.x + d.y * d.y);
+    }
+    const auto r = std::sqrt(r2);
+    b = {rcenter.x - r, rcenter.y - r, rcenter.x + r, rcenter.y + r};
+  }
+
+  // Lines and points are rasterized up to a pixel past their coordinates
+  const bool v = b.x - 1.0f <= cull_rect_.z && b.z + 1.0f >= cull_rect_.x &&
+                 b.y - 1.0f <= cull_rect_.w && b.w + 1.0f >= cull_rect_.y;
+  count_(v ? 1 : 0, v ? 0 : 1);
+  return v;
+}
+
+bool Gfx2D::visible_rect_(glm::vec2 xy, glm::vec2 size, glm::vec2 rcenter, float angle) {
+  // Any corner can be the one furthest from rcenter, so all four go in
+  return visible_({xy, {xy.x + size.x, xy.y}, xy + size, {xy.x, xy.y + size.y}}, rcenter, angle);
+}
+
+void Gfx2D::count_(std::size_t submitted, std::size_t culled) {
+  // A single primitive only ever touches one of them
+  if (submitted > 0)
+    frame_submitted_.fetch_add(submitted, std::memory_order_relaxed);
+  if (culled > 0)
+    frame_culled_.fetch_add(culled, std::memory_order_relaxed);
+}
+
+void Gfx2D::r_start_frame_(const E_StartFrame& p) {
+  last_submitted_ = frame_submitted_.exchange(0, std::memory_order_relaxed);
+  last_culled_ = frame_culled_.exchange(0, std::memory_order_relaxed);
+
+  if (!cull_projection_)
+    update_cull_rect_();
+}
 } // namespace imp
@@ -0,0 +1,134 @@
+#include "imp/gfx/module/2d/layer_mgr.hpp"
+
+#include "glm/gtc/matrix_transform.hpp"
+#include "imgui.h"
+#include <cmath>
+
+namespace imp {
+RenderLayer::RenderLayer(glm::vec4 region, glm::ivec2 resolution) : region_(region), resolution_(resolution) {}
+
+glm::vec4 RenderLayer::region() const {
+  return region_;
+}
+
+glm::ivec2 RenderLayer::resolution() const {
+  return resolution_;
+}
+
+void RenderLayer::invalidate() {
+  valid_ = false;
+}
+
+bool RenderLayer::valid() const {
+  return valid_;
+}
+
+void RenderLayer::set_pos(glm::vec2 xy) {
+  region_.x = xy.x;
+  region_.y = xy.y;
+}
+
+LayerMgr::LayerMgr(const std::weak_ptr<ModuleMgr>& module_mgr) : Module(module_mgr) {
+  gfx = module_mgr.lock()->get<Gfx2D>();
+  batcher = gfx->batcher;
+
+  gfx->ctx->debug_overlay->add_tab(module_name, [&] {
+    ImGui::Separator();
+
+    ImGui::Text("Layer hits: %zu", last_hits_);
+    ImGui::Text("Layer misses: %zu", last_misses_);
+  });
+
+  IMP_HERMES_SUB(E_StartFrame, module_name, r_start_frame_);
+}
+
+std::shared_ptr<RenderLayer> LayerMgr::create(glm::vec4 region, glm::ivec2 resolution) {
+  if (resolution.x <= 0 || resolution.y <= 0)
+    resolution = {
+      std::max(1, static_cast<int>(std::ceil(region.z))),
+      std::max(1, static_cast<int>(std::ceil(region.w)))
+    };
+
+  return std::make_shared<RenderLayer>(region, resolution);
+}
+
+void LayerMgr::draw(RenderLayer& layer, const std::function<void()>& build, const Color& c) {
+  if (!layer.valid_) {
+    build_(layer, build);
+    frame_misses_++;
+  } else
+    frame_hits_++;
+
+  const auto& r = layer.region_;
+  if (gfx->is_culling()) {
+    const auto view = gfx->cull_rect();
+    if (r.x > view.z || r.y > view.w || r.x + r.z < view.x || r.y + r.w < view.y)
+      return;
+  }
+
+  // The layer was drawn with y down, so the top of the region is the top of the texture
+  const auto gl_c = c.gl_color();
+  const auto z = batcher->current_z();
+  batcher->add_trans_tex(TexTarget::tex_2d, layer.fbo_->color()->id, {
+    r.x,       r.y,       z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+    r.x + r.z, r.y,       z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+    r.x + r.z, r.y + r.w, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+    r.x,       r.y + r.w, z, gl_c.r, gl_c.g, gl_c.b, gl_c.a, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+  }, {0, 1, 2, 0, 2, 3});
+}
+
+void LayerMgr::build_(RenderLayer& layer, const std::function<void()>& build) {
+  auto& ctx = *gfx->ctx;
+
+  if (!layer.fbo_) {
+    layer.fbo_ = std::make_unique<Framebuffer>(ctx, layer.resolution_.x, layer.resolution_.y);
+    layer.fbo_->attach_color(TexFormat::rgba8);
+    layer.fbo_->attach_depth_stencil(RBufFormat::d24_s8);
+    layer.fbo_->is_complete();
+  }
+
+  const auto& r = layer.region_;
+  const auto projection = glm::ortho(r.x, r.x + r.z, r.y + r.w, r.y, 0.0f, 1.0f);
+
+  // Nothing is culled while recording, but shapes pick their detail from the layer's resolution
+  const auto prev_cull = gfx->cull_projection();
+  gfx->set_cull_projection(projection);
+
+  StaticBatch batch;
+  {
+    auto scope = batch.record();
+    build();
+  }
+
+  if (prev_cull)
+    gfx->set_cull_projection(*prev_cull);
+  else
+    gfx->reset_cull_projection();
+
+  // Layers can be built in the middle of drawing into some other target
+  const auto prev_draw = ctx.framebuffer(GL_DRAW_FRAMEBUFFER);
+  const auto prev_read = ctx.framebuffer(GL_READ_FRAMEBUFFER);
+  const auto viewport = ctx.viewport();
+
+  layer.fbo_->bind();
+  ctx.viewport(0, 0, layer.resolution_.x, layer.resolution_.y);
+  ctx.depth_mask(true);
+  ctx.gl.ClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  ctx.gl.Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+  batcher->draw_static(batch, projection);
+
+  ctx.bind_framebuffer(GL_DRAW_FRAMEBUFFER, prev_draw);
+  ctx.bind_framebuffer(GL_READ_FRAMEBUFFER, prev_read);
+  ctx.viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+  layer.valid_ = true;
+}
+
+void LayerMgr::r_start_frame_(const E_StartFrame& p) {
+  last_hits_ = frame_hits_;
+  last_misses_ = frame_misses_;
+  frame_hits_ = 0;
+  frame_misses_ = 0;
+}
+} // namespace imp
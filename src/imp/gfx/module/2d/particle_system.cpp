@@ -0,0 +1,351 @@
+#include "imp/gfx/module/2d/particle_system.hpp"
+
+#include "imp/core/module/application.hpp"
+#include "imp/util/io.hpp"
+#include "imp/util/log.hpp"
+#include "imgui.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+
+namespace imp {
+namespace {
+constexpr GLuint PARTICLE_GROUP_SIZE = 256;
+
+// Same hash as particles_sim.glsl
+std::uint32_t pcg(std::uint32_t v) {
+  const std::uint32_t state = v * 747796405u + 2891336453u;
+  const std::uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+  return (word >> 22u) ^ word;
+}
+
+float rand01(std::uint32_t& s) {
+  s = pcg(s);
+  return static_cast<float>(s) / 4294967295.0f;
+}
+
+GLuint groups(std::size_t n) {
+  return static_cast<GLuint>((n + PARTICLE_GROUP_SIZE - 1) / PARTICLE_GROUP_SIZE);
+}
+
+struct ParticleCorner {
+  glm::vec2 corner;
+};
+
+// One per particle, instanced
+struct ParticleInstance {
+  glm::vec3 particle;
+};
+
+constexpr VertexLayout PARTICLE_CORNER = vertex_layout<ParticleCorner>(
+  vertex_attrib("in_corner", &ParticleCorner::corner)
+);
+
+constexpr VertexLayout PARTICLE_INSTANCE = vertex_layout<ParticleInstance>(
+  vertex_attrib("in_particle", &ParticleInstance::particle, 1)
+);
+} // namespace
+
+ParticlePool::ParticlePool(GfxContext& gfx, std::size_t capacity, const ParticleParams& params,
+                           ParticleBackend backend)
+  : params(params), ctx_(gfx), capacity_(capacity), backend_(backend),
+    instances_(gfx), draw_cmd_(gfx), vao_(gfx) {
+  instances_.bind(BufTarget::array);
+  gfx.gl.BufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity * 3 * sizeof(float)), nullptr, GL_STREAM_DRAW);
+  instances_.unbind(BufTarget::array);
+
+  if (backend == ParticleBackend::gpu) {
+    // Zeroed lifetimes mean every slot starts out dead
+    for (auto& f: fields_) {
+      f.emplace(gfx);
+      f->bind(BufTarget::shader_storage);
+      gfx.gl.BufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(capacity * sizeof(float)), nullptr,
+                        GL_DYNAMIC_COPY);
+      gfx.gl.ClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32F, GL_RED, GL_FLOAT, nullptr);
+      f->unbind(BufTarget::shader_storage);
+    }
+
+    const GLuint cmd[5] = {6, 0, 0, 0, 0};
+    draw_cmd_.bind(BufTarget::draw_indirect);
+    gfx.gl.BufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(cmd), cmd, GL_DYNAMIC_COPY);
+    draw_cmd_.unbind(BufTarget::draw_indirect);
+  } else {
+    px_.resize(capacity, 0.0f);
+    py_.resize(capacity, 0.0f);
+    vx_.resize(capacity, 0.0f);
+    vy_.resize(capacity, 0.0f);
+    age_.resize(capacity, 0.0f);
+    life_.resize(capacity, 0.0f);
+    cpu_instances_.resize(capacity * 3, 0.0f);
+  }
+}
+
+std::size_t ParticlePool::capacity() const {
+  return capacity_;
+}
+
+ParticleBackend ParticlePool::backend() const {
+  return backend_;
+}
+
+std::optional<std::size_t> ParticlePool::alive() const {
+  if (backend_ == ParticleBackend::cpu)
+    return alive_;
+  return std::nullopt;
+}
+
+ParticleSystem::ParticleSystem(const std::weak_ptr<ModuleMgr>& module_mgr) : Module(module_mgr) {
+  ctx = module_mgr.lock()->get<GfxContext>();
+  shaders = module_mgr.lock()->get<ShaderMgr>();
+
+  if (const auto src = shaders->parse(DATA_FOLDER / "shader" / "particles.glsl"))
+    draw_shader_ = shaders->compile(*src);
+  if (draw_shader_) {
+    draw_mvp_ = draw_shader_->uniform<glm::mat4>("mvp");
+    draw_size_ = draw_shader_->uniform<glm::vec2>("size");
+    draw_color_start_ = draw_shader_->uniform<glm::vec4>("color_start");
+    draw_color_end_ = draw_shader_->uniform<glm::vec4>("color_end");
+  }
+
+  // Compute shaders are core in 4.3, anything older gets the CPU path
+  compute_ = (ctx->version.x > 4 || (ctx->version.x == 4 && ctx->version.y >= 3)) &&
+             ctx->gl.DispatchCompute != nullptr;
+  if (compute_) {
+    if (const auto src = shaders->parse(DATA_FOLDER / "shader" / "particles_sim.glsl"))
+      sim_shader_ = shaders->compile(*src);
+    compute_ = sim_shader_ && sim_shader_->linked();
+  }
+  if (compute_) {
+    emit_first_ = sim_shader_->uniform<unsigned int>("emit_first");
+    emit_count_ = sim_shader_->uniform<unsigned int>("emit_count");
+    emit_seed_ = sim_shader_->uniform<unsigned int>("seed");
+    emit_pos_ = sim_shader_->uniform<glm::vec2>("emit_pos");
+    emit_radius_ = sim_shader_->uniform<float>("emit_radius");
+
+    sim_capacity_ = sim_shader_->uniform<unsigned int>("capacity");
+    sim_mode_ = sim_shader_->uniform<unsigned int>("mode");
+    sim_speed_ = sim_shader_->uniform<glm::vec2>("speed");
+    sim_angle_ = sim_shader_->uniform<glm::vec2>("angle");
+    sim_lifetime_ = sim_shader_->uniform<glm::vec2>("lifetime");
+    sim_dt_ = sim_shader_->uniform<float>("dt");
+    sim_gravity_ = sim_shader_->uniform<glm::vec2>("gravity");
+    sim_damping_ = sim_shader_->uniform<float>("damping");
+  } else
+    IMP_LOG_WARN("Compute shaders aren't available, particles will be simulated on the CPU");
+
+  quad_vbo_.emplace(*ctx, BufTarget::array, BufUsage::static_draw, std::vector{
+    -0.5f, -0.5f,
+     0.5f, -0.5f,
+     0.5f,  0.5f,
+    -0.5f,  0.5f,
+  });
+  quad_ebo_.emplace(*ctx, BufTarget::element_array, BufUsage::static_draw, std::vector{0u, 1u, 2u, 0u, 2u, 3u});
+
+  ctx->debug_overlay->add_tab(module_name, [&] {
+    ImGui::Separator();
+
+    ImGui::Text("Compute: %s", compute_ ? "yes" : "no");
+    ImGui::Text("Pools: %zu", pools_.size());
+    ImGui::Text("Simulation: %.3f ms", last_sim_ms_);
+    ImGui::Text("Alive (CPU pools): %zu", last_cpu_alive_);
+  });
+
+  // After Application, so anything emitted during its update is simulated the same frame
+  IMP_HERMES_SUB(E_Update, module_name, r_update_, Application);
+}
+
+std::shared_ptr<ParticlePool> ParticleSystem::create(std::size_t capacity, const ParticleParams& params,
+                                                     ParticleBackend backend) {
+  if (capacity == 0) {
+    IMP_LOG_ERROR("Particle pool capacity must be greater than 0");
+    return nullptr;
+  }
+
+  if (backend == ParticleBackend::gpu && !compute_)
+    backend = ParticleBackend::cpu;
+
+  auto pool = std::make_shared<ParticlePool>(*ctx, capacity, params, backend);
+  if (draw_shader_) {
+    pool->vao_.attrib(*draw_shader_, *quad_vbo_, PARTICLE_CORNER);
+    pool->vao_.attrib(*draw_shader_, pool->instances_, PARTICLE_INSTANCE);
+    pool->vao_.element_array(*quad_ebo_);
+  }
+
+  pools_.emplace_back(pool);
+  return pool;
+}
+
+void ParticleSystem::emit(ParticlePool& pool, glm::vec2 xy, std::size_t count, float radius) {
+  count = std::min(count, pool.capacity_);
+  if (count == 0)
+    return;
+
+  pool.pending_.emplace_back(xy, radius, static_cast<std::uint32_t>(pool.head_), static_cast<std::uint32_t>(count),
+                             pcg(pool.seed_++));
+  pool.head_ = (pool.head_ + count) % pool.capacity_;
+}
+
+void ParticleSystem::draw(ParticlePool& pool, const glm::mat4& projection) {
+  if (!draw_shader_)
+    return;
+  if (pool.backend_ == ParticleBackend::cpu && pool.alive_ == 0)
+    return;
+
+  draw_shader_->use();
+  draw_shader_->set(draw_mvp_, projection);
+  draw_shader_->set(draw_size_, pool.params.size);
+  draw_shader_->set(draw_color_start_, pool.params.color_start.gl_color());
+  draw_shader_->set(draw_color_end_, pool.params.color_end.gl_color());
+
+  ctx->blend_func_separate(
+    BlendFunc::one, BlendFunc::one_minus_src_alpha,
+    BlendFunc::one_minus_dst_alpha, BlendFunc::one);
+  ctx->enable(Capability::blend);
+
+  pool.vao_.bind();
+  if (pool.backend_ == ParticleBackend::gpu) {
+    pool.draw_cmd_.bind(BufTarget::draw_indirect);
+    ctx->gl.DrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr);
+    pool.draw_cmd_.unbind(BufTarget::draw_indirect);
+  } else
+    ctx->gl.DrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(pool.alive_));
+  pool.vao_.unbind();
+
+  ctx->disable(Capability::blend);
+}
+
+void ParticleSystem::simulate_gpu_(ParticlePool& pool, float dt) {
+  auto& gl = ctx->gl;
+  const auto& params = pool.params;
+
+  sim_shader_->use();
+  for (GLuint i = 0; i < pool.fields_.size(); ++i)
+    ctx->bind_buffer_base(GL_SHADER_STORAGE_BUFFER, i, pool.fields_[i]->id);
+  ctx->bind_buffer_base(GL_SHADER_STORAGE_BUFFER, 6, pool.instances_.id);
+  ctx->bind_buffer_base(GL_SHADER_STORAGE_BUFFER, 7, pool.draw_cmd_.id);
+
+  sim_shader_->set(sim_capacity_, static_cast<GLuint>(pool.capacity_));
+
+  if (!pool.pending_.empty()) {
+    sim_shader_->set(sim_mode_, 0u);
+    sim_shader_->set(sim_speed_, params.speed);
+    sim_shader_->set(sim_angle_, glm::radians(params.angle));
+    sim_shader_->set(sim_lifetime_, params.lifetime);
+
+    // A later emit can wrap around onto slots an earlier one just wrote, so each waits on the last
+    for (const auto& e: pool.pending_) {
+      sim_shader_->set(emit_first_, e.first);
+      sim_shader_->set(emit_count_, e.count);
+      sim_shader_->set(emit_seed_, e.seed);
+      sim_shader_->set(emit_pos_, e.xy);
+      sim_shader_->set(emit_radius_, e.radius);
+      gl.DispatchCompute(groups(e.count), 1, 1);
+      gl.MemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+  }
+
+  // The update pass counts the survivors into the draw command from zero
+  const GLuint zero = 0;
+  pool.draw_cmd_.bind(BufTarget::shader_storage);
+  gl.BufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), sizeof(GLuint), &zero);
+  pool.draw_cmd_.unbind(BufTarget::shader_storage);
+
+  sim_shader_->set(sim_mode_, 1u);
+  sim_shader_->set(sim_dt_, dt);
+  sim_shader_->set(sim_gravity_, params.gravity);
+  sim_shader_->set(sim_damping_, std::pow(1.0f - std::clamp(params.drag, 0.0f, 1.0f), dt));
+  gl.DispatchCompute(groups(pool.capacity_), 1, 1);
+
+  // Drawn from the instance buffer and command, and the count is reset by a buffer update next frame
+  gl.MemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+void ParticleSystem::simulate_cpu_(ParticlePool& pool, float dt) {
+  const auto& params = pool.params;
+  const auto n = pool.capacity_;
+
+  const auto angle = glm::radians(params.angle);
+  for (const auto& e: pool.pending_) {
+    for (std::uint32_t i = 0; i < e.count; ++i) {
+      const auto slot = (e.first + i) % n;
+      std::uint32_t s = e.seed ^ (i * 0x9E3779B9u);
+
+      const auto r = e.radius * std::sqrt(rand01(s));
+      const auto ra = 2.0f * std::numbers::pi_v<float> * rand01(s);
+      const auto a = std::lerp(angle.x, angle.y, rand01(s));
+      const auto v = std::lerp(params.speed.x, params.speed.y, rand01(s));
+
+      pool.px_[slot] = e.xy.x + r * std::cos(ra);
+      pool.py_[slot] = e.xy.y + r * std::sin(ra);
+      pool.vx_[slot] = v * std::cos(a);
+      pool.vy_[slot] = v * std::sin(a);
+      pool.age_[slot] = 0.0f;
+      pool.life_[slot] = std::lerp(params.lifetime.x, params.lifetime.y, rand01(s));
+    }
+  }
+
+  // No branches and one field per statement, so these vectorize. Dead particles are masked out
+  // instead of skipped
+  const auto gx = params.gravity.x * dt;
+  const auto gy = params.gravity.y * dt;
+  const auto damping = std::pow(1.0f - std::clamp(params.drag, 0.0f, 1.0f), dt);
+
+  auto* __restrict px = pool.px_.data();
+  auto* __restrict py = pool.py_.data();
+  auto* __restrict vx = pool.vx_.data();
+  auto* __restrict vy = pool.vy_.data();
+  auto* __restrict age = pool.age_.data();
+  const auto* __restrict life = pool.life_.data();
+
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto m = age[i] < life[i] ? 1.0f : 0.0f;
+    vx[i] += m * ((vx[i] + gx) * damping - vx[i]);
+    vy[i] += m * ((vy[i] + gy) * damping - vy[i]);
+    px[i] += m * vx[i] * dt;
+    py[i] += m * vy[i] * dt;
+    age[i] += m * dt;
+  }
+
+  auto* inst = pool.cpu_instances_.data();
+  std::size_t alive = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    inst[alive * 3 + 0] = px[i];
+    inst[alive * 3 + 1] = py[i];
+    inst[alive * 3 + 2] = age[i] / life[i];
+    alive += age[i] < life[i] ? 1 : 0;
+  }
+  pool.alive_ = alive;
+
+  if (alive > 0) {
+    // Orphan first so the driver doesn't wait on last frame's draw
+    const auto size = static_cast<GLsizeiptr>(n * 3 * sizeof(float));
+    pool.instances_.bind(BufTarget::array);
+    ctx->gl.BufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    ctx->gl.BufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(alive * 3 * sizeof(float)), inst);
+    pool.instances_.unbind(BufTarget::array);
+  }
+}
+
+void ParticleSystem::r_update_(const E_Update& p) {
+  std::erase_if(pools_, [](const auto& w) { return w.expired(); });
+
+  const auto start = std::chrono::steady_clock::now();
+  std::size_t cpu_alive = 0;
+
+  for (const auto& w: pools_) {
+    const auto pool = w.lock();
+    if (pool->backend_ == ParticleBackend::gpu)
+      simulate_gpu_(*pool, static_cast<float>(p.dt));
+    else {
+      simulate_cpu_(*pool, static_cast<float>(p.dt));
+      cpu_alive += pool->alive_;
+    }
+    pool->pending_.clear();
+  }
+
+  // GPU pools only count their submission here
+  last_sim_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  last_cpu_alive_ = cpu_alive;
+}
+} // namespace imp
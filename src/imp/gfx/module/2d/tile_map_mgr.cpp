@@ -0,0 +1,170 @@
+#include "imp/gfx/module/2d/tile_map_mgr.hpp"
+
+#include "glm/gtc/matrix_transform.hpp"
+#include "imgui.h"
+#include <algorithm>
+#include <cmath>
+
+namespace imp {
+TileMap::TileMap(glm::ivec2 size, std::shared_ptr<Texture> tileset, glm::ivec2 tile_size)
+  : size_(size), tile_size_(tile_size), tileset_(std::move(tileset)),
+    tiles_(static_cast<std::size_t>(size.x) * size.y, EMPTY_TILE),
+    chunk_count_((size.x + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE, (size.y + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE),
+    chunks_(static_cast<std::size_t>(chunk_count_.x) * chunk_count_.y) {}
+
+int TileMap::w() const {
+  return size_.x;
+}
+
+int TileMap::h() const {
+  return size_.y;
+}
+
+glm::ivec2 TileMap::tile_size() const {
+  return tile_size_;
+}
+
+const std::shared_ptr<Texture>& TileMap::tileset() const {
+  return tileset_;
+}
+
+TileId TileMap::get(int x, int y) const {
+  if (x < 0 || y < 0 || x >= size_.x || y >= size_.y)
+    return EMPTY_TILE;
+  return tiles_[static_cast<std::size_t>(y) * size_.x + x];
+}
+
+void TileMap::set(int x, int y, TileId tile) {
+  if (x < 0 || y < 0 || x >= size_.x || y >= size_.y)
+    return;
+
+  auto& t = tiles_[static_cast<std::size_t>(y) * size_.x + x];
+  if (t == tile)
+    return;
+
+  t = tile;
+  chunks_[static_cast<std::size_t>(y / TILE_CHUNK_SIZE) * chunk_count_.x + x / TILE_CHUNK_SIZE].dirty = true;
+}
+
+void TileMap::fill(TileId tile) {
+  std::ranges::fill(tiles_, tile);
+  for (auto& c: chunks_)
+    c.dirty = true;
+}
+
+TileMapMgr::TileMapMgr(const std::weak_ptr<ModuleMgr>& module_mgr) : Module(module_mgr) {
+  gfx = module_mgr.lock()->get<Gfx2D>();
+  batcher = gfx->batcher;
+  textures = gfx->textures;
+
+  gfx->ctx->debug_overlay->add_tab(module_name, [&] {
+    ImGui::Separator();
+
+    ImGui::Text("Chunks drawn: %zu", last_chunks_drawn_);
+    ImGui::Text("Chunks built: %zu", last_chunks_built_);
+    ImGui::Text("Chunks resident: %zu", chunks_resident_);
+  });
+
+  IMP_HERMES_SUB(E_StartFrame, module_name, r_start_frame_);
+}
+
+std::shared_ptr<TileMap> TileMapMgr::create(glm::ivec2 size, std::shared_ptr<Texture> tileset, glm::ivec2 tile_size) {
+  return std::make_shared<TileMap>(size, std::move(tileset), tile_size);
+}
+
+void TileMapMgr::draw(TileMap& map, glm::vec2 xy) {
+  const auto view = gfx->cull_rect();
+  const glm::vec2 chunk_px = glm::vec2(map.tile_size_) * static_cast<float>(TILE_CHUNK_SIZE);
+
+  const int cx0 = std::max(0, static_cast<int>(std::floor((view.x - xy.x) / chunk_px.x)));
+  const int cy0 = std::max(0, static_cast<int>(std::floor((view.y - xy.y) / chunk_px.y)));
+  const int cx1 = std::min(map.chunk_count_.x - 1, static_cast<int>(std::floor((view.z - xy.x) / chunk_px.x)));
+  const int cy1 = std::min(map.chunk_count_.y - 1, static_cast<int>(std::floor((view.w - xy.y) / chunk_px.y)));
+
+  const auto transform = glm::translate(glm::mat4(1.0f), glm::vec3(xy, 0.0f));
+
+  for (int cy = cy0; cy <= cy1; ++cy) {
+    for (int cx = cx0; cx <= cx1; ++cx) {
+      auto& chunk = map.chunks_[static_cast<std::size_t>(cy) * map.chunk_count_.x + cx];
+      if (!chunk.batch || chunk.dirty)
+        build_chunk_(map, cx, cy);
+
+      batcher->add_static(*chunk.batch, transform);
+      chunk.last_drawn = frame_;
+      frame_chunks_drawn_++;
+    }
+  }
+
+  evict_(map);
+}
+
+void TileMapMgr::build_chunk_(TileMap& map, int cx, int cy) {
+  const auto idx = static_cast<std::size_t>(cy) * map.chunk_count_.x + cx;
+  auto& chunk = map.chunks_[idx];
+  if (!chunk.batch) {
+    chunk.batch = batcher->create_static();
+    map.resident_.emplace_back(idx);
+  }
+
+  const auto& t = *map.tileset_;
+  const int cols = std::max(1, t.w() / map.tile_size_.x);
+  const float tw = static_cast<float>(map.tile_size_.x), th = static_cast<float>(map.tile_size_.y);
+  const float du = tw / static_cast<float>(t.w()), dv = th / static_cast<float>(t.h());
+  const auto l = static_cast<float>(t.layer());
+
+  const int x0 = cx * TILE_CHUNK_SIZE, y0 = cy * TILE_CHUNK_SIZE;
+  const int x1 = std::min(x0 + TILE_CHUNK_SIZE, map.size_.x), y1 = std::min(y0 + TILE_CHUNK_SIZE, map.size_.y);
+
+  {
+    auto scope = chunk.batch->record();
+    for (int y = y0; y < y1; ++y) {
+      for (int x = x0; x < x1; ++x) {
+        const auto tile = map.tiles_[static_cast<std::size_t>(y) * map.size_.x + x];
+        if (tile == EMPTY_TILE)
+          continue;
+
+        const float px = x * tw, py = y * th;
+        const float u = static_cast<float>((tile - 1) % cols) * du, v = static_cast<float>((tile - 1) / cols) * dv;
+        const auto z = batcher->current_z();
+        const std::initializer_list<float> vdata = {
+          px,      py,      z, 1.0f, 1.0f, 1.0f, 1.0f, u,      v,      l, 0.0f, 0.0f, 0.0f,
+          px + tw, py,      z, 1.0f, 1.0f, 1.0f, 1.0f, u + du, v,      l, 0.0f, 0.0f, 0.0f,
+          px + tw, py + th, z, 1.0f, 1.0f, 1.0f, 1.0f, u + du, v + dv, l, 0.0f, 0.0f, 0.0f,
+          px,      py + th, z, 1.0f, 1.0f, 1.0f, 1.0f, u,      v + dv, l, 0.0f, 0.0f, 0.0f,
+        };
+        const std::initializer_list<unsigned int> idata = {0, 1, 2, 0, 2, 3};
+
+        if (t.fully_opaque())
+          batcher->add_opaque_tex(t.target(), t.id(), vdata, idata);
+        else
+          batcher->add_trans_tex(t.target(), t.id(), vdata, idata);
+      }
+    }
+  }
+
+  chunk.dirty = false;
+  frame_chunks_built_++;
+}
+
+void TileMapMgr::evict_(TileMap& map) {
+  std::erase_if(map.resident_, [&](std::size_t idx) {
+    auto& chunk = map.chunks_[idx];
+    if (frame_ - chunk.last_drawn <= TILE_CHUNK_EVICT_FRAMES)
+      return false;
+
+    chunk.batch.reset();
+    chunk.dirty = true;
+    return true;
+  });
+  chunks_resident_ = map.resident_.size();
+}
+
+void TileMapMgr::r_start_frame_(const E_StartFrame& p) {
+  frame_++;
+
+  last_chunks_drawn_ = frame_chunks_drawn_;
+  last_chunks_built_ = frame_chunks_built_;
+  frame_chunks_drawn_ = 0;
+  frame_chunks_built_ = 0;
+}
+} // namespace imp
@@ -0,0 +1,280 @@
+#include "imp/gfx/module/font_mgr.hpp"
+
+#include "imp/util/log.hpp"
+#include "imp/util/rnd.hpp"
+#include "imgui.h"
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <iterator>
+
+// imgui compiles its own copy of stb_truetype with internal linkage, so we do the same
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "imstb_truetype.h"
+
+namespace imp {
+namespace {
+// Decode one code point and advance i past it, malformed sequences decode as U+FFFD
+int next_codepoint(std::string_view s, std::size_t& i) {
+  const auto b0 = static_cast<unsigned char>(s[i++]);
+  if (b0 < 0x80)
+    return b0;
+
+  int len, cp;
+  if ((b0 & 0xE0) == 0xC0) {
+    len = 1;
+    cp = b0 & 0x1F;
+  } else if ((b0 & 0xF0) == 0xE0) {
+    len = 2;
+    cp = b0 & 0x0F;
+  } else if ((b0 & 0xF8) == 0xF0) {
+    len = 3;
+    cp = b0 & 0x07;
+  } else
+    return 0xFFFD;
+
+  for (int n = 0; n < len; ++n) {
+    if (i >= s.size() || (static_cast<unsigned char>(s[i]) & 0xC0) != 0x80)
+      return 0xFFFD;
+    cp = (cp << 6) | (static_cast<unsigned char>(s[i++]) & 0x3F);
+  }
+  return cp;
+}
+
+std::uint64_t run_key(std::uint32_t font_id, float size, std::string_view text) {
+  auto h = std::hash<std::string_view>{}(text);
+  h ^= (static_cast<std::uint64_t>(font_id) << 32 | std::bit_cast<std::uint32_t>(size)) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+  return h;
+}
+} // namespace
+
+Font::Font(const std::string& name, std::uint32_t id, std::vector<unsigned char> bytes)
+  : name_(name), id_(id), bytes_(std::move(bytes)), info_(std::make_unique<stbtt_fontinfo>()) {
+  const auto offset = stbtt_GetFontOffsetForIndex(bytes_.data(), 0);
+  if (offset < 0 || !stbtt_InitFont(info_.get(), bytes_.data(), offset)) {
+    info_.reset();
+    return;
+  }
+
+  int ascent, descent, line_gap;
+  stbtt_GetFontVMetrics(info_.get(), &ascent, &descent, &line_gap);
+
+  scale_ = stbtt_ScaleForPixelHeight(info_.get(), FONT_SDF_SIZE);
+  ascent_ = ascent * scale_;
+  descent_ = descent * scale_;
+  line_gap_ = line_gap * scale_;
+}
+
+Font::~Font() = default;
+
+std::string Font::name() const {
+  return name_;
+}
+
+bool Font::valid() const {
+  return info_ != nullptr;
+}
+
+float Font::line_height(float size) const {
+  return (ascent_ - descent_ + line_gap_) * size / FONT_SDF_SIZE;
+}
+
+FontMgr::FontMgr(const std::weak_ptr<ModuleMgr>& module_mgr) : Module(module_mgr) {
+  ctx = module_mgr.lock()->get<GfxContext>();
+
+  atlas_.emplace(*ctx, TexFormat::r8, FONT_ATLAS_SIZE, FONT_ATLAS_SIZE);
+  atlas_->bind();
+  ctx->gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  ctx->gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  // Storage starts out undefined, and empty space has to read as "outside" for the SDF
+  const std::vector<unsigned char> zeros(static_cast<std::size_t>(FONT_ATLAS_SIZE) * FONT_ATLAS_SIZE, 0);
+  ctx->gl.PixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  ctx->gl.TexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, FONT_ATLAS_SIZE, FONT_ATLAS_SIZE, GL_RED, GL_UNSIGNED_BYTE, zeros.data());
+  ctx->gl.PixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  atlas_->unbind();
+
+  ctx->debug_overlay->add_tab(module_name, [&] {
+    ImGui::Separator();
+
+    ImGui::Text("Fonts: %zu", fonts_.size());
+    ImGui::Text("Glyphs: %zu", glyphs_.size());
+    ImGui::Text("Atlas: %.1f%%%s",
+                100.0 * std::min(shelf_y_ + shelf_h_, FONT_ATLAS_SIZE) / FONT_ATLAS_SIZE,
+                atlas_full_ ? " (full)" : "");
+    ImGui::Text("Runs cached: %zu", runs_.size());
+    ImGui::Text("Run hits: %zu", last_hits_);
+    ImGui::Text("Run misses: %zu", last_misses_);
+  });
+
+  IMP_HERMES_SUB(E_StartFrame, module_name, r_start_frame_);
+}
+
+std::shared_ptr<Font> FontMgr::load(const std::string& name, const std::filesystem::path& path) {
+  auto it = fonts_.find(name);
+  if (it != fonts_.end())
+    return it->second;
+
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs.is_open()) {
+    IMP_LOG_ERROR("Failed to open font: '{}'", path.string());
+    return nullptr;
+  }
+  std::vector<unsigned char> bytes{std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()};
+
+  auto font = std::make_shared<Font>(name, next_font_id_++, std::move(bytes));
+  if (!font->valid()) {
+    IMP_LOG_ERROR("Failed to parse font: '{}'", path.string());
+    return nullptr;
+  }
+
+  IMP_LOG_DEBUG("Loaded font '{}'", path.string());
+
+  it = fonts_.emplace_hint(it, name, std::move(font));
+  return it->second;
+}
+
+std::shared_ptr<Font> FontMgr::load(const std::filesystem::path& path) {
+  return load(rnd::base58(11), path);
+}
+
+const TextRun& FontMgr::shape(const Font& font, std::string_view text, float size) {
+  const auto key = run_key(font.id_, size, text);
+
+  auto it = runs_.find(key);
+  if (it != runs_.end() && it->second.font_id == font.id_ && it->second.size == size && it->second.text == text) {
+    it->second.last_used = frame_;
+    frame_hits_++;
+    return it->second.run;
+  }
+
+  if (it == runs_.end())
+    it = runs_.emplace_hint(it, key, Run_{});
+
+  auto& r = it->second;
+  r.font_id = font.id_;
+  r.size = size;
+  r.text = text;
+  r.last_used = frame_;
+  layout_(font, text, size, r.run);
+
+  frame_misses_++;
+  return r.run;
+}
+
+glm::vec2 FontMgr::measure(const Font& font, std::string_view text, float size) {
+  return shape(font, text, size).size;
+}
+
+GLuint FontMgr::atlas_id() const {
+  return atlas_->id;
+}
+
+const FontMgr::Glyph_& FontMgr::glyph_(const Font& font, int codepoint) {
+  const auto key = static_cast<std::uint64_t>(font.id_) << 32 | static_cast<std::uint32_t>(codepoint);
+
+  auto it = glyphs_.find(key);
+  if (it != glyphs_.end())
+    return it->second;
+
+  int advance, lsb;
+  stbtt_GetCodepointHMetrics(font.info_.get(), codepoint, &advance, &lsb);
+
+  Glyph_ g{.uv = {}, .offset = {}, .size = {}, .advance = advance * font.scale_, .empty = true};
+
+  int w, h, xoff, yoff;
+  const auto sdf = stbtt_GetCodepointSDF(
+    font.info_.get(), font.scale_, codepoint,
+    FONT_SDF_PADDING, 128, 128.0f / FONT_SDF_PADDING,
+    &w, &h, &xoff, &yoff
+  );
+  if (sdf) {
+    if (const auto p = pack_(w, h)) {
+      atlas_->bind();
+      ctx->gl.PixelStorei(GL_UNPACK_ALIGNMENT, 1);
+      ctx->gl.TexSubImage2D(GL_TEXTURE_2D, 0, p->x, p->y, w, h, GL_RED, GL_UNSIGNED_BYTE, sdf);
+      ctx->gl.PixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+      const auto a = static_cast<float>(FONT_ATLAS_SIZE);
+      g.uv = {p->x / a, p->y / a, (p->x + w) / a, (p->y + h) / a};
+      g.offset = {xoff, yoff};
+      g.size = {w, h};
+      g.empty = false;
+    }
+    stbtt_FreeSDF(sdf, nullptr);
+  }
+
+  return glyphs_.emplace_hint(it, key, g)->second;
+}
+
+std::optional<glm::ivec2> FontMgr::pack_(GLsizei w, GLsizei h) {
+  // 1px gap so linear filtering never picks up a neighbour
+  if (shelf_x_ + w > FONT_ATLAS_SIZE) {
+    shelf_y_ += shelf_h_ + 1;
+    shelf_x_ = 0;
+    shelf_h_ = 0;
+  }
+
+  if (w > FONT_ATLAS_SIZE || shelf_y_ + h > FONT_ATLAS_SIZE) {
+    if (!atlas_full_)
+      IMP_LOG_WARN("Glyph atlas is full, new glyphs will be skipped");
+    atlas_full_ = true;
+    return std::nullopt;
+  }
+
+  const glm::ivec2 p = {shelf_x_, shelf_y_};
+  shelf_x_ += w + 1;
+  shelf_h_ = std::max(shelf_h_, h);
+  return p;
+}
+
+void FontMgr::layout_(const Font& font, std::string_view text, float size, TextRun& run) {
+  run.quads.clear();
+
+  const auto k = size / FONT_SDF_SIZE;
+  glm::vec2 pen = {0.0f, font.ascent_ * k};
+  float max_x = 0.0f;
+  int lines = 1;
+  int prev = 0;
+
+  for (std::size_t i = 0; i < text.size();) {
+    const auto cp = next_codepoint(text, i);
+    if (cp == '\n') {
+      max_x = std::max(max_x, pen.x);
+      pen.x = 0.0f;
+      pen.y += font.line_height(size);
+      lines++;
+      prev = 0;
+      continue;
+    }
+
+    if (prev != 0)
+      pen.x += stbtt_GetCodepointKernAdvance(font.info_.get(), prev, cp) * font.scale_ * k;
+
+    const auto& g = glyph_(font, cp);
+    if (!g.empty) {
+      const auto p0 = pen + g.offset * k;
+      const auto p1 = p0 + g.size * k;
+      run.quads.emplace_back(TextRun::Quad{.pos = {p0.x, p0.y, p1.x, p1.y}, .uv = g.uv});
+    }
+
+    pen.x += g.advance * k;
+    prev = cp;
+  }
+
+  max_x = std::max(max_x, pen.x);
+  run.size = {max_x, (lines - 1) * font.line_height(size) + (font.ascent_ - font.descent_) * k};
+}
+
+void FontMgr::r_start_frame_(const E_StartFrame& p) {
+  frame_++;
+
+  last_hits_ = frame_hits_;
+  last_misses_ = frame_misses_;
+  frame_hits_ = 0;
+  frame_misses_ = 0;
+
+  std::erase_if(runs_, [&](const auto& kv) { return frame_ - kv.second.last_used > FONT_RUN_EVICT_FRAMES; });
+}
+} // namespace imp
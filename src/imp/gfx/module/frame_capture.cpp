@@ -0,0 +1,239 @@
+#include "imp/gfx/module/frame_capture.hpp"
+
+#include "imp/util/log.hpp"
+#include "fmt/format.h"
+#include "imgui.h"
+#include "stb_image_write.h"
+#include <cstring>
+#include <fstream>
+
+namespace imp {
+FrameCapture::FrameCapture(const std::weak_ptr<ModuleMgr>& module_mgr) : Module(module_mgr) {
+  ctx = module_mgr.lock()->get<GfxContext>();
+
+  for (std::size_t i = 0; i < CAPTURE_RING_SIZE; ++i)
+    slots_.emplace_back(Slot_{.pbo = Buffer(*ctx)});
+
+  worker_ = std::jthread([&](std::stop_token st) { work_(st); });
+
+  ctx->debug_overlay->add_tab(module_name, [&] {
+    ImGui::Separator();
+
+    if (recording_.active)
+      ImGui::Text("Recording: frame %zu", recording_.frame);
+    else
+      ImGui::Text("Recording: off");
+    ImGui::Text("Frames captured: %zu", frames_captured_);
+    ImGui::Text("Frames dropped: %zu", frames_dropped_);
+
+    std::size_t queued;
+    {
+      const std::lock_guard lock(mutex_);
+      queued = jobs_.size();
+    }
+    ImGui::Text("Waiting to encode: %zu", queued);
+  });
+
+  // No dependencies so this runs before Application renders imgui, and before Window swaps
+  IMP_HERMES_SUB(E_EndFrame, module_name, r_end_frame_);
+}
+
+FrameCapture::~FrameCapture() {
+  // ctx keeps the window alive, but modules can be torn down off the GL thread. Anything already
+  // read back still gets written out if GL can be used, otherwise it's dropped without touching GL
+  if (glfwGetCurrentContext() == ctx->window->handle())
+    collect_(true);
+  else
+    for (auto& s: slots_)
+      if (s.fence) {
+        s.fence = nullptr;
+        frames_dropped_++;
+      }
+
+  worker_.request_stop();
+  worker_.join();
+}
+
+void FrameCapture::screenshot(const std::filesystem::path& path) {
+  screenshot_path_ = path;
+}
+
+void FrameCapture::start_recording(const std::filesystem::path& dir, CaptureFormat format) {
+  std::error_code ec;
+  std::filesystem::create_directories(dir, ec);
+  if (ec) {
+    IMP_LOG_ERROR("Failed to create capture directory '{}': {}", dir.string(), ec.message());
+    return;
+  }
+
+  recording_.active = true;
+  recording_.dir = dir;
+  recording_.format = format;
+  recording_.frame = 0;
+  IMP_LOG_INFO("Recording frames to '{}'", dir.string());
+}
+
+void FrameCapture::stop_recording() {
+  if (!recording_.active)
+    return;
+
+  recording_.active = false;
+  IMP_LOG_INFO("Recorded {} frames to '{}'", recording_.frame, recording_.dir.string());
+}
+
+bool FrameCapture::is_recording() const {
+  return recording_.active;
+}
+
+bool FrameCapture::read_(const std::filesystem::path& path, CaptureFormat format) {
+  int w, h;
+  glfwGetFramebufferSize(ctx->window->handle(), &w, &h);
+  if (w <= 0 || h <= 0)
+    return false;
+
+  // Every slot is still waiting on the GPU, better to lose a frame than to stall
+  auto& s = slots_[next_slot_];
+  if (s.fence) {
+    frames_dropped_++;
+    return false;
+  }
+  next_slot_ = (next_slot_ + 1) % slots_.size();
+
+  const auto size = static_cast<std::size_t>(w) * h * 4;
+
+  s.pbo.bind(BufTarget::pixel_pack);
+  if (size > s.capacity) {
+    ctx->gl.BufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+    s.capacity = size;
+  }
+
+  ctx->bind_framebuffer(GL_READ_FRAMEBUFFER, 0);
+  ctx->gl.ReadBuffer(GL_BACK);
+  ctx->gl.ReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  s.fence = ctx->gl.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  s.pbo.unbind(BufTarget::pixel_pack);
+
+  s.path = path;
+  s.format = format;
+  s.w = w;
+  s.h = h;
+  return true;
+}
+
+void FrameCapture::collect_(bool wait) {
+  // Oldest first, so frames reach the worker in the order they were drawn
+  for (std::size_t i = 0; i < slots_.size(); ++i) {
+    auto& s = slots_[(next_slot_ + i) % slots_.size()];
+    if (!s.fence)
+      continue;
+
+    const auto r = ctx->gl.ClientWaitSync(
+      s.fence,
+      wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+      wait ? GL_TIMEOUT_IGNORED : 0
+    );
+    if (r == GL_TIMEOUT_EXPIRED)
+      break;
+
+    ctx->gl.DeleteSync(s.fence);
+    s.fence = nullptr;
+
+    if (r == GL_WAIT_FAILED) {
+      IMP_LOG_ERROR("Waiting on a frame capture failed, dropping it");
+      frames_dropped_++;
+      continue;
+    }
+
+    std::vector<unsigned char> pixels;
+    {
+      const std::lock_guard lock(mutex_);
+      if (jobs_.size() >= CAPTURE_QUEUE_MAX) {
+        frames_dropped_++;
+        continue;
+      }
+      if (!spare_.empty()) {
+        pixels = std::move(spare_.back());
+        spare_.pop_back();
+      }
+    }
+
+    const auto size = static_cast<std::size_t>(s.w) * s.h * 4;
+    pixels.resize(size);
+
+    s.pbo.bind(BufTarget::pixel_pack);
+    if (const auto p = ctx->gl.MapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT)) {
+      std::memcpy(pixels.data(), p, size);
+      ctx->gl.UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else {
+      IMP_LOG_ERROR("Failed to map frame capture buffer, dropping it");
+      frames_dropped_++;
+      s.pbo.unbind(BufTarget::pixel_pack);
+      continue;
+    }
+    s.pbo.unbind(BufTarget::pixel_pack);
+
+    {
+      const std::lock_guard lock(mutex_);
+      jobs_.emplace_back(s.path, s.format, s.w, s.h, std::move(pixels));
+    }
+    cv_.notify_one();
+    frames_captured_++;
+  }
+}
+
+void FrameCapture::work_(std::stop_token st) {
+  while (true) {
+    Job_ job;
+    {
+      std::unique_lock lock(mutex_);
+
+      // Returns false only once a stop is requested and there's nothing left to write
+      if (!cv_.wait(lock, st, [&] { return !jobs_.empty(); }))
+        return;
+
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+
+    encode_(job);
+
+    const std::lock_guard lock(mutex_);
+    spare_.emplace_back(std::move(job.pixels));
+  }
+}
+
+void FrameCapture::encode_(const Job_& job) {
+  const auto stride = job.w * 4;
+  const auto last_row = job.pixels.data() + static_cast<std::size_t>(job.h - 1) * stride;
+
+  if (job.format == CaptureFormat::png) {
+    // Negative stride flips the image, without touching stb's global flip flag
+    if (!stbi_write_png(job.path.string().c_str(), job.w, job.h, 4, last_row, -stride))
+      IMP_LOG_ERROR("Failed to write frame capture '{}'", job.path.string());
+    return;
+  }
+
+  std::ofstream ofs(job.path, std::ios::binary);
+  if (!ofs.is_open()) {
+    IMP_LOG_ERROR("Failed to open frame capture '{}'", job.path.string());
+    return;
+  }
+  for (int y = 0; y < job.h; ++y)
+    ofs.write(reinterpret_cast<const char*>(last_row - static_cast<std::ptrdiff_t>(y) * stride), stride);
+}
+
+void FrameCapture::r_end_frame_(const E_EndFrame& p) {
+  collect_(false);
+
+  // A screenshot waits for a free slot, and recorded frames are only numbered once they're read,
+  // so a dropped frame never leaves a gap in the file names
+  if (screenshot_path_ && read_(*screenshot_path_, CaptureFormat::png))
+    screenshot_path_.reset();
+
+  if (recording_.active) {
+    const auto ext = recording_.format == CaptureFormat::png ? "png" : "rgba";
+    if (read_(recording_.dir / fmt::format("frame_{:06}.{}", recording_.frame, ext), recording_.format))
+      recording_.frame++;
+  }
+}
+} // namespace imp
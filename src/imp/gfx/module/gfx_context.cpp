@@ -1,9 +1,12 @@
 #include "imp/gfx/module/gfx_context.hpp"
 
 #define GLFW_INCLUDE_NONE
+#include "imp/core/module/application.hpp"
+#include "imp/gfx/gl/render_target_pool.hpp"
 #include "imp/util/log.hpp"
 #include "imp/util/platform.hpp"
 #include "imgui.h"
+#include <ranges>
 #if defined(IMP_PLATFORM_WINDOWS)
 #define GLFW_EXPOSE_NATIVE_WIN32
 #define GLFW_EXPOSE_NATIVE_WGL
@@ -58,13 +61,32 @@ GfxContext::GfxContext(const std::weak_ptr<ModuleMgr>& module_mgr, WindowOpenPar
   gl.DebugMessageCallback(gl_message_callback_, nullptr);
 #endif
 
+  render_targets = std::make_shared<RenderTargetPool>(*this);
+
   debug_overlay->add_tab(module_name, [&] {
     ImGui::Separator();
 
     if (bool v = is_vsync(); ImGui::Checkbox("Vsync", &v)) {
       set_vsync(v);
     }
+
+    ImGui::Separator();
+
+    const auto& calls = last_frame_gl_calls_;
+    ImGui::Text("GL state calls issued: %zu", calls.issued);
+    ImGui::Text("GL state calls elided: %zu", calls.elided);
+
+    ImGui::Separator();
+
+    const auto& targets = render_targets->stats();
+    ImGui::Text("Render targets pooled: %zu", targets.pooled);
+    ImGui::Text("Render targets in use: %zu", targets.in_use);
+    ImGui::Text("Render targets allocated: %zu", targets.allocated);
   });
+
+  IMP_HERMES_SUB(E_Update, module_name, r_update_);
+  IMP_HERMES_SUB(E_EndFrame, module_name, r_end_frame_, Application);
+  IMP_HERMES_SUB(E_GlfwFramebufferSize, module_name, r_glfw_framebuffer_size_);
 }
 
 bool GfxContext::is_vsync() const {
@@ -76,25 +98,226 @@ void GfxContext::set_vsync(bool v) {
 }
 
 void GfxContext::enable(const Capability& capability) {
+  auto it = capabilities_.find(unwrap(capability));
+  if (!issue_(it == capabilities_.end() || !it->second))
+    return;
+
   gl.Enable(unwrap(capability));
+  capabilities_[unwrap(capability)] = true;
 }
 
 void GfxContext::disable(const Capability& capability) {
+  auto it = capabilities_.find(unwrap(capability));
+  if (!issue_(it == capabilities_.end() || it->second))
+    return;
+
   gl.Disable(unwrap(capability));
+  capabilities_[unwrap(capability)] = false;
 }
 
 void GfxContext::blend_func(const BlendFunc& sfactor, const BlendFunc& dfactor) {
-  gl.BlendFunc(unwrap(sfactor), unwrap(dfactor));
+  blend_func_separate(sfactor, dfactor, sfactor, dfactor);
 }
 
 void GfxContext::blend_func_separate(const BlendFunc& sfactor_rgb, const BlendFunc& dfactor_rgb,
                                      const BlendFunc& sfactor_alpha, const BlendFunc& dfactor_alpha) {
-  gl.BlendFuncSeparate(unwrap(sfactor_rgb), unwrap(dfactor_rgb),
-                       unwrap(sfactor_alpha), unwrap(dfactor_alpha));
+  const std::array<GLenum, 4> funcs = {
+    unwrap(sfactor_rgb), unwrap(dfactor_rgb), unwrap(sfactor_alpha), unwrap(dfactor_alpha)
+  };
+  if (!issue_(blend_funcs_ != funcs))
+    return;
+
+  gl.BlendFuncSeparate(funcs[0], funcs[1], funcs[2], funcs[3]);
+  blend_funcs_ = funcs;
 }
 
 void GfxContext::depth_mask(bool enable) {
+  if (!issue_(depth_mask_ != enable))
+    return;
+
   gl.DepthMask(enable ? GL_TRUE : GL_FALSE);
+  depth_mask_ = enable;
+}
+
+void GfxContext::primitive_restart_index(GLuint index) {
+  if (!issue_(primitive_restart_index_ != index))
+    return;
+
+  gl.PrimitiveRestartIndex(index);
+  primitive_restart_index_ = index;
+}
+
+void GfxContext::viewport(GLint x, GLint y, GLsizei w, GLsizei h) {
+  const std::array<GLint, 4> rect{x, y, w, h};
+  if (!issue_(viewport_ != rect))
+    return;
+
+  gl.Viewport(x, y, w, h);
+  viewport_ = rect;
+}
+
+std::array<GLint, 4> GfxContext::viewport() {
+  if (!viewport_) {
+    std::array<GLint, 4> rect{};
+    gl.GetIntegerv(GL_VIEWPORT, rect.data());
+    viewport_ = rect;
+  }
+  return *viewport_;
+}
+
+bool GfxContext::use_program(GLuint id) {
+  if (!issue_(program_ != id))
+    return false;
+
+  gl.UseProgram(id);
+  program_ = id;
+  return true;
+}
+
+bool GfxContext::bind_vertex_array(GLuint id) {
+  if (!issue_(vertex_array_ != id))
+    return false;
+
+  gl.BindVertexArray(id);
+  vertex_array_ = id;
+
+  // The element array binding is part of the VAO
+  buffers_.erase(GL_ELEMENT_ARRAY_BUFFER);
+  return true;
+}
+
+bool GfxContext::bind_buffer(GLenum target, GLuint id) {
+  auto it = buffers_.find(target);
+  if (!issue_(it == buffers_.end() || it->second != id))
+    return false;
+
+  gl.BindBuffer(target, id);
+  buffers_[target] = id;
+  return true;
+}
+
+void GfxContext::bind_buffer_base(GLenum target, GLuint index, GLuint id) {
+  gl.BindBufferBase(target, index, id);
+  buffers_[target] = id;
+}
+
+bool GfxContext::bind_texture(GLenum target, GLuint id, GLuint unit) {
+  if (issue_(active_texture_unit_ != unit)) {
+    gl.ActiveTexture(GL_TEXTURE0 + unit);
+    active_texture_unit_ = unit;
+  }
+
+  auto& unit_textures = textures_[unit];
+  auto it = unit_textures.find(target);
+  if (!issue_(it == unit_textures.end() || it->second != id))
+    return false;
+
+  gl.BindTexture(target, id);
+  unit_textures[target] = id;
+  return true;
+}
+
+bool GfxContext::bind_framebuffer(GLenum target, GLuint id) {
+  const bool draw = target != GL_READ_FRAMEBUFFER;
+  const bool read = target != GL_DRAW_FRAMEBUFFER;
+  if (!issue_((draw && draw_framebuffer_ != id) || (read && read_framebuffer_ != id)))
+    return false;
+
+  gl.BindFramebuffer(target, id);
+  if (draw)
+    draw_framebuffer_ = id;
+  if (read)
+    read_framebuffer_ = id;
+  return true;
+}
+
+GLuint GfxContext::framebuffer(GLenum target) {
+  const bool read = target == GL_READ_FRAMEBUFFER;
+  auto& bound = read ? read_framebuffer_ : draw_framebuffer_;
+  if (!bound) {
+    GLint id;
+    gl.GetIntegerv(read ? GL_READ_FRAMEBUFFER_BINDING : GL_DRAW_FRAMEBUFFER_BINDING, &id);
+    bound = static_cast<GLuint>(id);
+  }
+  return *bound;
+}
+
+void GfxContext::forget_program(GLuint id) {
+  if (program_ == id)
+    program_.reset();
+}
+
+void GfxContext::forget_vertex_array(GLuint id) {
+  if (vertex_array_ == id) {
+    vertex_array_ = 0;
+    buffers_.erase(GL_ELEMENT_ARRAY_BUFFER);
+  }
+}
+
+void GfxContext::forget_buffer(GLuint id) {
+  for (auto& bound: buffers_ | std::views::values)
+    if (bound == id)
+      bound = 0;
+}
+
+void GfxContext::forget_texture(GLuint id) {
+  for (auto& unit_textures: textures_ | std::views::values)
+    for (auto& bound: unit_textures | std::views::values)
+      if (bound == id)
+        bound = 0;
+}
+
+void GfxContext::forget_framebuffer(GLuint id) {
+  // GL falls back to the default framebuffer
+  if (draw_framebuffer_ == id)
+    draw_framebuffer_ = 0;
+  if (read_framebuffer_ == id)
+    read_framebuffer_ = 0;
+}
+
+void GfxContext::invalidate_state_cache() {
+  program_.reset();
+  vertex_array_.reset();
+  buffers_.clear();
+  active_texture_unit_.reset();
+  textures_.clear();
+  draw_framebuffer_.reset();
+  read_framebuffer_.reset();
+  capabilities_.clear();
+  blend_funcs_.reset();
+  depth_mask_.reset();
+  primitive_restart_index_.reset();
+  viewport_.reset();
+}
+
+const GlCallStats& GfxContext::gl_call_stats() const {
+  return last_frame_gl_calls_;
+}
+
+bool GfxContext::issue_(bool needed) {
+  if (needed)
+    frame_gl_calls_.issued++;
+  else
+    frame_gl_calls_.elided++;
+  return needed;
+}
+
+void GfxContext::r_update_(const E_Update& p) {
+  Hermes::poll<E_GlfwFramebufferSize>(module_name);
+}
+
+void GfxContext::r_end_frame_(const E_EndFrame& p) {
+  last_frame_gl_calls_ = frame_gl_calls_;
+  frame_gl_calls_ = {};
+
+  render_targets->end_frame_();
+}
+
+void GfxContext::r_glfw_framebuffer_size_(const E_GlfwFramebufferSize& p) {
+  render_targets->resize_screen_({p.width, p.height});
+
+  // Whoever handles the resize sets the new viewport, don't let the old one elide it
+  viewport_.reset();
 }
 
 void GfxContext::gl_message_callback_(
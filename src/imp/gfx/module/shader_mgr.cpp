@@ -1,10 +1,46 @@
 #include "imp/gfx/module/shader_mgr.hpp"
 
+#include "imp/util/io.hpp"
+#include "imp/util/log.hpp"
 #include "imp/util/rnd.hpp"
+#include "imp/util/sops.hpp"
+#include "imp/util/time.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 
 namespace imp {
+namespace {
+// Cache files start with this, followed by the binary format, the compile time it saves
+// and the size of the binary
+constexpr char CACHE_MAGIC[4] = {'I', 'M', 'P', 'B'};
+} // namespace
+
 ShaderMgr::ShaderMgr(const std::weak_ptr<ModuleMgr>& module_mgr): Module(module_mgr) {
   ctx = module_mgr.lock()->get<GfxContext>();
+
+  // Binaries are only good for the exact driver that made them
+  GLint formats = 0;
+  if (ctx->gl.ProgramBinary && ctx->gl.GetProgramBinary)
+    ctx->gl.GetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+  cache_ = formats > 0;
+
+  if (cache_) {
+    const auto gl_str = [&](GLenum e) {
+      const auto* s = reinterpret_cast<const char*>(ctx->gl.GetString(e));
+      return std::string(s ? s : "");
+    };
+    driver_ = gl_str(GL_VENDOR) + '\n' + gl_str(GL_RENDERER) + '\n' + gl_str(GL_VERSION);
+
+    cache_dir_ = DATA_FOLDER / "shader_cache";
+    std::error_code ec;
+    std::filesystem::create_directories(cache_dir_, ec);
+    if (ec) {
+      IMP_LOG_WARN("Failed to create shader cache folder '{}', shaders won't be cached", cache_dir_.string());
+      cache_ = false;
+    }
+  } else
+    IMP_LOG_DEBUG("Program binaries aren't supported, shaders won't be cached");
 }
 
 std::shared_ptr<Shader> ShaderMgr::get(const std::string& name) {
@@ -13,13 +49,160 @@ std::shared_ptr<Shader> ShaderMgr::get(const std::string& name) {
 }
 
 std::shared_ptr<Shader> ShaderMgr::compile(const std::string& name, const ShaderSrc& src) {
-  if (!shaders_.contains(name)) {
-    shaders_[name] = std::make_shared<Shader>(*ctx, src);
+  if (shaders_.contains(name))
+    return shaders_[name];
+
+  if (!cache_)
+    return shaders_[name] = std::make_shared<Shader>(*ctx, src);
+
+  const auto path = cache_path_(src);
+
+  Stopwatch sw;
+  sw.start();
+  const auto entry = read_cache_(path);
+  auto shader = entry ? std::make_shared<Shader>(*ctx, src, entry->binary) : std::make_shared<Shader>(*ctx, src);
+  sw.stop();
+
+  if (shader->from_binary()) {
+    const auto saved = std::max(0.0, entry->compile_msec - sw.elapsed_msec());
+    saved_msec_ += saved;
+    IMP_LOG_INFO("Loaded shader '{}' from cache in {:.2f}ms, saved {:.2f}ms ({:.2f}ms total)",
+                 name, sw.elapsed_msec(), saved, saved_msec_);
+  } else if (shader->linked()) {
+    if (const auto binary = shader->binary())
+      write_cache_(path, *binary, sw.elapsed_msec());
   }
-  return shaders_[name];
+
+  return shaders_[name] = shader;
 }
 
 std::shared_ptr<Shader> ShaderMgr::compile(const ShaderSrc& src) {
   return compile(src.name.value_or(rnd::base58(11)), src);
 }
+
+std::optional<ShaderSrc> ShaderMgr::parse(const std::filesystem::path& path) {
+  const auto key = path.lexically_normal().string();
+
+  if (auto it = parsed_.find(key); it != parsed_.end()) {
+    const auto unchanged = std::ranges::all_of(it->second.deps, [](const auto& dep) {
+      std::error_code ec;
+      return std::filesystem::last_write_time(dep.first, ec) == dep.second && !ec;
+    });
+    if (unchanged)
+      return it->second.src;
+  }
+
+  Parsed_ parsed{};
+  auto src = ShaderSrc::parse(path, [&](const std::filesystem::path& file) -> std::optional<std::string> {
+    const auto* f = read_file_(file);
+    if (!f)
+      return std::nullopt;
+    parsed.deps.emplace_back(file, f->mtime);
+    return f->text;
+  });
+  if (!src)
+    return std::nullopt;
+
+  parsed.src = *src;
+  parsed_.insert_or_assign(key, std::move(parsed));
+  return src;
+}
+
+bool ShaderMgr::reload(const std::string& name, const std::filesystem::path& path) {
+  auto it = shaders_.find(name);
+  if (it == shaders_.end()) {
+    IMP_LOG_WARN("Can't reload shader '{}', it hasn't been compiled", name);
+    return false;
+  }
+
+  const auto src = parse(path);
+  if (!src)
+    return false;
+
+  if (src->hash() == it->second->src_hash()) {
+    IMP_LOG_DEBUG("Shader '{}' is unchanged, not recompiling", name);
+    return true;
+  }
+
+  it->second->recompile(*src);
+  return true;
+}
+
+const ShaderMgr::File_* ShaderMgr::read_file_(const std::filesystem::path& path) {
+  std::error_code ec;
+  const auto mtime = std::filesystem::last_write_time(path, ec);
+  if (ec)
+    return nullptr;
+
+  const auto key = path.lexically_normal().string();
+  if (auto it = files_.find(key); it != files_.end() && it->second.mtime == mtime)
+    return &it->second;
+
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs.is_open())
+    return nullptr;
+
+  File_ f{mtime, std::string{std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()}};
+  return &files_.insert_or_assign(key, std::move(f)).first->second;
+}
+
+std::filesystem::path ShaderMgr::cache_path_(const ShaderSrc& src) const {
+  // Includes have already been pulled in by parse, so the hash covers the full source
+  const auto h = fnv1a(driver_, src.hash());
+  return cache_dir_ / fmt::format("{:016x}.bin", h);
+}
+
+std::optional<ShaderMgr::CacheEntry_> ShaderMgr::read_cache_(const std::filesystem::path& path) const {
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs.is_open())
+    return std::nullopt;
+
+  char magic[4]{};
+  std::uint32_t format = 0;
+  double compile_msec = 0.0;
+  std::uint64_t size = 0;
+  ifs.read(magic, sizeof(magic));
+  ifs.read(reinterpret_cast<char*>(&format), sizeof(format));
+  ifs.read(reinterpret_cast<char*>(&compile_msec), sizeof(compile_msec));
+  ifs.read(reinterpret_cast<char*>(&size), sizeof(size));
+  if (!ifs || std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0) {
+    IMP_LOG_WARN("Ignoring malformed shader cache file '{}'", path.string());
+    return std::nullopt;
+  }
+
+  // The size has to match what's actually left, before anything is allocated for it
+  const auto pos = ifs.tellg();
+  ifs.seekg(0, std::ios::end);
+  const auto end = ifs.tellg();
+  ifs.seekg(pos);
+  if (pos < 0 || end < pos || size != static_cast<std::uint64_t>(end - pos)) {
+    IMP_LOG_WARN("Ignoring truncated shader cache file '{}'", path.string());
+    return std::nullopt;
+  }
+
+  CacheEntry_ entry{{static_cast<GLenum>(format), std::vector<std::byte>(size)}, compile_msec};
+  ifs.read(reinterpret_cast<char*>(entry.binary.data.data()), static_cast<std::streamsize>(size));
+  if (!ifs) {
+    IMP_LOG_WARN("Failed to read shader cache file '{}'", path.string());
+    return std::nullopt;
+  }
+
+  return entry;
+}
+
+void ShaderMgr::write_cache_(const std::filesystem::path& path, const ShaderBinary& binary, double compile_msec) const {
+  std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+  if (!ofs.is_open()) {
+    IMP_LOG_WARN("Failed to open shader cache file '{}'", path.string());
+    return;
+  }
+
+  const auto format = static_cast<std::uint32_t>(binary.format);
+  const auto size = static_cast<std::uint64_t>(binary.data.size());
+  ofs.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+  ofs.write(reinterpret_cast<const char*>(&format), sizeof(format));
+  ofs.write(reinterpret_cast<const char*>(&compile_msec), sizeof(compile_msec));
+  ofs.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  ofs.write(reinterpret_cast<const char*>(binary.data.data()), static_cast<std::streamsize>(size));
+}
 } // namespace imp
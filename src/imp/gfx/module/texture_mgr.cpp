@@ -5,32 +5,45 @@
 namespace imp {
 Texture::Texture(const std::string& name, TexImage& ti) : name_(name), ti_(std::move(ti)) {}
 
+Texture::Texture(const std::string& name, std::shared_ptr<TexArray> arr, GLsizei layer, bool fully_opaque)
+  : name_(name), arr_(std::move(arr)), layer_(layer), arr_fully_opaque_(fully_opaque) {}
+
 std::string Texture::name() const {
   return name_;
 }
 
+TexTarget Texture::target() const {
+  return arr_ ? TexTarget::tex_2d_array : TexTarget::tex_2d;
+}
+
 GLuint Texture::id() const {
-  return ti_.id;
+  return arr_ ? arr_->id : ti_->id;
+}
+
+GLsizei Texture::layer() const {
+  return layer_;
 }
 
 int Texture::w() const {
-  return ti_.w;
+  return arr_ ? arr_->w : ti_->w;
 }
 
 int Texture::h() const {
-  return ti_.h;
+  return arr_ ? arr_->h : ti_->h;
 }
 
 bool Texture::fully_opaque() const {
-  return ti_.fully_opaque;
+  return arr_ ? arr_fully_opaque_ : ti_->fully_opaque;
 }
 
 bool Texture::flipped() const {
-  return ti_.flipped;
+  return arr_ ? false : ti_->flipped;
 }
 
 TextureMgr::TextureMgr(const std::weak_ptr<ModuleMgr>& module_mgr) : Module(module_mgr) {
   ctx = module_mgr.lock()->get<GfxContext>();
+
+  ctx->gl.GetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_array_layers_);
 }
 
 std::shared_ptr<Texture> TextureMgr::load(const std::string& name, const std::filesystem::path& path, bool retro) {
@@ -45,4 +58,53 @@ std::shared_ptr<Texture> TextureMgr::load(const std::string& name, const std::fi
 std::shared_ptr<Texture> TextureMgr::load(const std::filesystem::path& path, bool retro) {
   return load(rnd::base58(11), path, retro);
 }
+
+std::shared_ptr<Texture> TextureMgr::load_layered(const std::string& name, const std::filesystem::path& path,
+                                                  bool retro) {
+  auto it = textures_.find(name);
+  if (it != textures_.end())
+    return it->second;
+
+  auto image_data = ImageData(path);
+  if (!image_data.bytes())
+    return nullptr;
+
+  bool fully_opaque = true;
+  if (image_data.comp() == 4) {
+    for (int i = 3; i < image_data.w() * image_data.h() * 4; i += 4) {
+      if (image_data[i] < 255) {
+        fully_opaque = false;
+        break;
+      }
+    }
+  }
+
+  auto tex_array = get_tex_array_(image_data.w(), image_data.h(), retro);
+  const auto layer = tex_array->add_layer(image_data);
+  if (!layer)
+    return nullptr;
+
+  IMP_LOG_DEBUG("Loaded texture '{}' ({}x{}) into array {} layer {}",
+                path.string(), image_data.w(), image_data.h(), tex_array->id, *layer);
+
+  it = textures_.emplace_hint(it, name, std::make_shared<Texture>(name, tex_array, *layer, fully_opaque));
+  return it->second;
+}
+
+std::shared_ptr<Texture> TextureMgr::load_layered(const std::filesystem::path& path, bool retro) {
+  return load_layered(rnd::base58(11), path, retro);
+}
+
+std::shared_ptr<TexArray> TextureMgr::get_tex_array_(GLsizei w, GLsizei h, bool retro) {
+  for (const auto& a: tex_arrays_)
+    if (a->w == w && a->h == h && a->retro == retro && !a->full())
+      return a;
+
+  const auto layer_bytes = static_cast<std::size_t>(w) * h * 4;
+  const auto capacity = std::clamp<GLsizei>(
+    static_cast<GLsizei>(TEX_ARRAY_BYTE_BUDGET / std::max<std::size_t>(layer_bytes, 1)),
+    1, std::max(max_array_layers_, 1));
+
+  return tex_arrays_.emplace_back(std::make_shared<TexArray>(*ctx, w, h, capacity, retro));
+}
 } // namespace imp
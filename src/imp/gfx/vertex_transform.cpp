@@ -0,0 +1,101 @@
+#include "imp/gfx/vertex_transform.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace imp {
+void rotate_points(
+  std::span<float> x, std::span<float> y,
+  std::span<const float> cx, std::span<const float> cy,
+  std::span<const float> c, std::span<const float> s
+) {
+  const auto n = std::min({x.size(), y.size(), cx.size(), cy.size(), c.size(), s.size()});
+  std::size_t i = 0;
+
+#if defined(__AVX2__)
+  for (; i + 8 <= n; i += 8) {
+    const auto vcx = _mm256_loadu_ps(&cx[i]), vcy = _mm256_loadu_ps(&cy[i]);
+    const auto vc = _mm256_loadu_ps(&c[i]), vs = _mm256_loadu_ps(&s[i]);
+    const auto dx = _mm256_sub_ps(_mm256_loadu_ps(&x[i]), vcx);
+    const auto dy = _mm256_sub_ps(_mm256_loadu_ps(&y[i]), vcy);
+    _mm256_storeu_ps(&x[i], _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(vc, dx), _mm256_mul_ps(vs, dy)), vcx));
+    _mm256_storeu_ps(&y[i], _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vs, dx), _mm256_mul_ps(vc, dy)), vcy));
+  }
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+  for (; i + 4 <= n; i += 4) {
+    const auto vcx = _mm_loadu_ps(&cx[i]), vcy = _mm_loadu_ps(&cy[i]);
+    const auto vc = _mm_loadu_ps(&c[i]), vs = _mm_loadu_ps(&s[i]);
+    const auto dx = _mm_sub_ps(_mm_loadu_ps(&x[i]), vcx);
+    const auto dy = _mm_sub_ps(_mm_loadu_ps(&y[i]), vcy);
+    _mm_storeu_ps(&x[i], _mm_add_ps(_mm_sub_ps(_mm_mul_ps(vc, dx), _mm_mul_ps(vs, dy)), vcx));
+    _mm_storeu_ps(&y[i], _mm_add_ps(_mm_add_ps(_mm_mul_ps(vs, dx), _mm_mul_ps(vc, dy)), vcy));
+  }
+#elif defined(__ARM_NEON)
+  for (; i + 4 <= n; i += 4) {
+    const auto vcx = vld1q_f32(&cx[i]), vcy = vld1q_f32(&cy[i]);
+    const auto vc = vld1q_f32(&c[i]), vs = vld1q_f32(&s[i]);
+    const auto dx = vsubq_f32(vld1q_f32(&x[i]), vcx);
+    const auto dy = vsubq_f32(vld1q_f32(&y[i]), vcy);
+    vst1q_f32(&x[i], vaddq_f32(vmlsq_f32(vmulq_f32(vc, dx), vs, dy), vcx));
+    vst1q_f32(&y[i], vaddq_f32(vmlaq_f32(vmulq_f32(vs, dx), vc, dy), vcy));
+  }
+#endif
+
+  for (; i < n; ++i) {
+    const auto dx = x[i] - cx[i], dy = y[i] - cy[i];
+    x[i] = c[i] * dx - s[i] * dy + cx[i];
+    y[i] = s[i] * dx + c[i] * dy + cy[i];
+  }
+}
+
+void VertexFlattener::flatten(std::span<const float> in, std::size_t floats_per_vertex, std::vector<float>& out) {
+  const auto fpv = floats_per_vertex;
+  const auto out_fpv = fpv - 3;
+  const auto n = in.size() / fpv;
+
+  x_.resize(n);
+  y_.resize(n);
+  cx_.resize(n);
+  cy_.resize(n);
+  c_.resize(n);
+  s_.resize(n);
+
+  // Every vertex of a primitive shares its angle, so the trig only runs when the angle changes
+  float last_angle = 0.0f, last_c = 1.0f, last_s = 0.0f;
+  for (std::size_t v = 0; v < n; ++v) {
+    const auto* p = &in[v * fpv];
+    const auto angle = p[fpv - 1];
+    if (angle != last_angle) {
+      last_angle = angle;
+      last_c = std::cos(angle);
+      last_s = std::sin(angle);
+    }
+
+    x_[v] = p[0];
+    y_[v] = p[1];
+    cx_[v] = p[fpv - 3];
+    cy_[v] = p[fpv - 2];
+    c_[v] = last_c;
+    s_[v] = last_s;
+  }
+
+  rotate_points(x_, y_, cx_, cy_, c_, s_);
+
+  out.resize(n * out_fpv);
+  for (std::size_t v = 0; v < n; ++v) {
+    const auto* p = &in[v * fpv];
+    auto* q = &out[v * out_fpv];
+    std::copy(p, p + out_fpv, q);
+    q[0] = x_[v];
+    q[1] = y_[v];
+  }
+}
+} // namespace imp
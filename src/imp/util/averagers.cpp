@@ -33,4 +33,20 @@ void SMA::update(double v) {
   }
 }
 
+WindowMax::WindowMax(std::size_t sample_count) : sample_count(sample_count) {}
+
+void WindowMax::update(double v) {
+  while (!window_.empty() && window_.back().second <= v)
+    window_.pop_back();
+  window_.emplace_back(seen_++, v);
+  if (window_.front().first + sample_count < seen_)
+    window_.pop_front();
+
+  value_ = window_.front().second;
+}
+
+bool WindowMax::full() const {
+  return seen_ >= sample_count;
+}
+
 } // namespace imp
@@ -38,6 +38,20 @@ std::string trim_copy(std::string s) {
   return s;
 }
 
+std::string_view rtrim_view(std::string_view s) {
+  while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back())))
+    s.remove_suffix(1);
+  return s;
+}
+
+std::uint64_t fnv1a(std::string_view s, std::uint64_t h) {
+  for (const unsigned char c: s) {
+    h ^= c;
+    h *= 0x100000001b3ull;
+  }
+  return h;
+}
+
 std::vector<std::string> split(const std::string &s, char delim) {
   std::vector<std::string> res;
 